@@ -2,41 +2,458 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <unordered_map>
 #include <algorithm>
 #include <chrono>
 #include <queue>
 #include <fstream>
 #include <sstream>
+#include <cmath>
+#include <climits>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <future>
+#include <deque>
+#include <tuple>
+#include <iomanip>
+#include <stdexcept>
+#include <cstring>
+#include <cassert>
+#include <cstdio>
+#include <cerrno>
+#include <filesystem>
+#include <atomic>
+
+// x86-64 builds carry AVX2 versions of the roadmap kernels alongside the scalar ones, and pick between them at run time (see cpuHasAvx2)
+#if defined(__x86_64__) || defined(_M_X64)
+#define LNS_AVX2_KERNELS
+#include <immintrin.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define AVX2_TARGET
+#else
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+#ifdef _WIN32
+// Without NOMINMAX windows.h defines min and max as macros, which break std::min and std::max
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#endif
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#ifndef _WIN32
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 
+// State of the random number generator (xorshift64*)
+// Every thread has its own so that concurrent solves neither contend on nor corrupt a shared generator
+thread_local unsigned long long randomState = 88172645463325252ULL;
+
+// Seeds the calling thread's random number generator
+void seedRandom(unsigned long long seed) {
+	// xorshift can never leave the all-zero state
+	randomState = seed != 0 ? seed : 88172645463325252ULL;
+}
+
+// Returns the next 32 random bits from the calling thread's random number generator
+unsigned int nextRandom() {
+	randomState ^= randomState >> 12;
+	randomState ^= randomState << 25;
+	randomState ^= randomState >> 27;
+	return (unsigned int)((randomState * 2685821657736338717ULL) >> 32);
+}
+
 // Returns a random int between min and max (both inclusive) using a uniform distribution
 int randomInt(int min, int max) {
-	return rand() % (max - min + 1) + min;
+	return nextRandom() % (max - min + 1) + min;
 }
 
 // Returns a random double between min and max (both inclusive) using a uniform distribution
 double randomDouble(double min, double max) {
-	double f = (double)rand() / RAND_MAX;
+	double f = (double)nextRandom() / UINT_MAX;
 	return min + f * (max - min);
 }
 
+// Shuffles the vector in place using the Fisher-Yates algorithm
+template <typename T>
+void randomShuffle(vector<T> &elements) {
+	for (int i = (int)elements.size() - 1; i > 0; --i)
+		swap(elements[i], elements[randomInt(0, i)]);
+}
+
+// Profiling counters ///////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+
+// The phases of a solve that are timed
+enum StatsTimer { TIMER_SOLVE, TIMER_CALIBRATION, TIMER_RADIAL_RUIN, TIMER_RANDOM_RUIN, TIMER_REPAIR, TIMER_ACCEPT, TIMER_FEASIBILITY, TIMER_BEST_COPY, TIMER_LOCAL_SEARCH, TIMER_OUTPUT, NUMBER_OF_TIMERS };
+const char *statsTimerNames[NUMBER_OF_TIMERS] = { "solve", "calibration", "radialRuin", "randomRuin", "repair", "accept", "isFeasible", "bestCopy", "localSearch", "output" };
+
+// The events of a solve that are counted
+enum StatsCounter { COUNTER_STORIES, COUNTER_ITERATIONS, COUNTER_VALID_INSERTS, COUNTER_TABU_HITS, COUNTER_RESTARTS, COUNTER_ACCEPTED, COUNTER_REJECTED, COUNTER_EXCHANGES, NUMBER_OF_COUNTERS };
+const char *statsCounterNames[NUMBER_OF_COUNTERS] = { "stories", "iterations", "validInserts", "tabuHits", "restarts", "accepted", "rejected", "exchanges" };
+
+// The hardware events counted in each phase with --perf
+enum PerfEvent { PERF_CYCLES, PERF_INSTRUCTIONS, PERF_L1D_MISSES, PERF_LLC_MISSES, PERF_BRANCH_MISSES, NUMBER_OF_PERF_EVENTS };
+const char *perfEventNames[NUMBER_OF_PERF_EVENTS] = { "cycles", "instructions", "L1dMisses", "LLCMisses", "branchMisses" };
+
+// Hardware counters are read at the start and end of every timed phase, which is too slow to do unless asked for
+bool perfEnabled = false;
+
+// The calling thread's hardware performance counters, opened with perf_event_open as one group so that a single read gets them all
+// Containers and locked-down kernels often refuse some or all of them, in which case those events just aren't counted
+class PerfCounters {
+public:
+	int groupFd;
+	int eventFds[NUMBER_OF_PERF_EVENTS];
+
+	// Where each event is in a read of the group, or -1 if it couldn't be opened
+	int groupPositions[NUMBER_OF_PERF_EVENTS];
+	int numberOfOpenEvents;
+
+	// Why the counters aren't available, if they aren't
+	string error;
+
+	PerfCounters() {
+		this->groupFd = -1;
+		this->numberOfOpenEvents = 0;
+
+		fill(eventFds, eventFds + NUMBER_OF_PERF_EVENTS, -1);
+		fill(groupPositions, groupPositions + NUMBER_OF_PERF_EVENTS, -1);
+
+#ifdef __linux__
+		unsigned int types[NUMBER_OF_PERF_EVENTS] = { PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE };
+		unsigned long long configs[NUMBER_OF_PERF_EVENTS] = {
+			PERF_COUNT_HW_CPU_CYCLES,
+			PERF_COUNT_HW_INSTRUCTIONS,
+			PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+			PERF_COUNT_HW_CACHE_MISSES,
+			PERF_COUNT_HW_BRANCH_MISSES
+		};
+
+		for (int event = 0; event < NUMBER_OF_PERF_EVENTS; ++event) {
+			perf_event_attr attributes;
+			memset(&attributes, 0, sizeof(attributes));
+
+			attributes.size = sizeof(attributes);
+			attributes.type = types[event];
+			attributes.config = configs[event];
+			attributes.disabled = groupFd == -1; // The group starts once all of its events are open
+			attributes.exclude_kernel = 1;
+			attributes.exclude_hv = 1;
+			attributes.read_format = PERF_FORMAT_GROUP;
+
+			// Counts this thread on whichever CPU it runs
+			int fd = syscall(__NR_perf_event_open, &attributes, 0, -1, groupFd, 0);
+
+			if (fd == -1) {
+				// The other events are only counted alongside the cycles
+				if (groupFd == -1) {
+					error = strerror(errno);
+					return;
+				}
+
+				continue;
+			}
+
+			if (groupFd == -1)
+				groupFd = fd;
+
+			eventFds[event] = fd;
+			groupPositions[event] = numberOfOpenEvents++;
+		}
+
+		ioctl(groupFd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+		ioctl(groupFd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#else
+		error = "hardware counters are only supported on Linux";
+#endif
+	}
+
+	PerfCounters(const PerfCounters&) = delete;
+	PerfCounters& operator = (const PerfCounters&) = delete;
+
+	~PerfCounters() {
+#ifdef __linux__
+		for (int fd : eventFds) {
+			if (fd != -1)
+				close(fd);
+		}
+#endif
+	}
+
+	bool available() {
+		return groupFd != -1;
+	}
+
+	// Reads the events' counts so far (0 for events that couldn't be opened)
+	void read(long long counts[NUMBER_OF_PERF_EVENTS]) {
+		fill(counts, counts + NUMBER_OF_PERF_EVENTS, 0);
+
+#ifdef __linux__
+		if (groupFd == -1)
+			return;
+
+		// The number of events in the group, followed by their counts
+		unsigned long long values[1 + NUMBER_OF_PERF_EVENTS];
+
+		if (::read(groupFd, values, sizeof(values)) < (ssize_t)sizeof(values[0]))
+			return;
+
+		for (int event = 0; event < NUMBER_OF_PERF_EVENTS; ++event) {
+			if (groupPositions[event] != -1 && groupPositions[event] < values[0])
+				counts[event] = values[1 + groupPositions[event]];
+		}
+#endif
+	}
+};
+
+PerfCounters &threadPerfCounters() {
+	thread_local PerfCounters perfCounters;
+	return perfCounters;
+}
+
+// Time spent in each phase, the number of times each event happened and, with --perf, the hardware events in each phase
+class SolveStats {
+public:
+	long long timerNanoseconds[NUMBER_OF_TIMERS];
+	long long timerCalls[NUMBER_OF_TIMERS];
+	long long counters[NUMBER_OF_COUNTERS];
+	long long perfCounts[NUMBER_OF_TIMERS][NUMBER_OF_PERF_EVENTS];
+
+	SolveStats() {
+		fill(timerNanoseconds, timerNanoseconds + NUMBER_OF_TIMERS, 0);
+		fill(timerCalls, timerCalls + NUMBER_OF_TIMERS, 0);
+		fill(counters, counters + NUMBER_OF_COUNTERS, 0);
+		fill(&perfCounts[0][0], &perfCounts[0][0] + NUMBER_OF_TIMERS * NUMBER_OF_PERF_EVENTS, 0);
+	}
+
+	void add(const SolveStats &other) {
+		for (int i = 0; i < NUMBER_OF_TIMERS; ++i) {
+			timerNanoseconds[i] += other.timerNanoseconds[i];
+			timerCalls[i] += other.timerCalls[i];
+
+			for (int event = 0; event < NUMBER_OF_PERF_EVENTS; ++event)
+				perfCounts[i][event] += other.perfCounts[i][event];
+		}
+
+		for (int i = 0; i < NUMBER_OF_COUNTERS; ++i)
+			counters[i] += other.counters[i];
+	}
+
+	string toText() {
+		ostringstream text;
+		text << fixed << setprecision(3);
+		text << left << setw(14) << "Phase" << right << setw(12) << "Calls" << setw(14) << "Total (ms)" << setw(14) << "Mean (us)" << endl;
+
+		for (int i = 0; i < NUMBER_OF_TIMERS; ++i) {
+			text << left << setw(14) << statsTimerNames[i] << right << setw(12) << timerCalls[i]
+				<< setw(14) << timerNanoseconds[i] / 1e6
+				<< setw(14) << (timerCalls[i] > 0 ? timerNanoseconds[i] / 1e3 / timerCalls[i] : 0.0) << endl;
+		}
+
+		for (int i = 0; i < NUMBER_OF_COUNTERS; ++i)
+			text << left << setw(14) << statsCounterNames[i] << right << setw(12) << counters[i] << endl;
+
+		if (perfEnabled) {
+			// Hardware events per iteration of the search, and per story for the solve as a whole
+			double iterations = max(1LL, counters[COUNTER_ITERATIONS]);
+			double stories = max(1LL, counters[COUNTER_STORIES]);
+
+			text << endl << left << setw(14) << "Per iteration" << right;
+
+			for (int event = 0; event < NUMBER_OF_PERF_EVENTS; ++event)
+				text << setw(14) << perfEventNames[event];
+
+			text << setw(8) << "IPC" << endl;
+
+			for (int i = 0; i < NUMBER_OF_TIMERS; ++i) {
+				if (timerCalls[i] == 0)
+					continue;
+
+				text << left << setw(14) << statsTimerNames[i] << right << setprecision(1);
+
+				for (int event = 0; event < NUMBER_OF_PERF_EVENTS; ++event)
+					text << setw(14) << perfCounts[i][event] / iterations;
+
+				text << setw(8) << setprecision(2) << (perfCounts[i][PERF_CYCLES] > 0 ? (double)perfCounts[i][PERF_INSTRUCTIONS] / perfCounts[i][PERF_CYCLES] : 0.0) << endl;
+			}
+
+			text << left << setw(14) << "Per story" << right << setprecision(1);
+
+			for (int event = 0; event < NUMBER_OF_PERF_EVENTS; ++event)
+				text << setw(14) << perfCounts[TIMER_SOLVE][event] / stories;
+
+			text << endl;
+		}
+
+		return text.str();
+	}
+
+	string toJson() {
+		ostringstream json;
+		json << "{\"timers\": {";
+
+		for (int i = 0; i < NUMBER_OF_TIMERS; ++i) {
+			json << (i > 0 ? ", " : "") << "\"" << statsTimerNames[i] << "\": {\"calls\": " << timerCalls[i]
+				<< ", \"totalMs\": " << timerNanoseconds[i] / 1e6 << "}";
+		}
+
+		json << "}, \"counters\": {";
+
+		for (int i = 0; i < NUMBER_OF_COUNTERS; ++i)
+			json << (i > 0 ? ", " : "") << "\"" << statsCounterNames[i] << "\": " << counters[i];
+
+		json << "}";
+
+		if (perfEnabled) {
+			json << ", \"perf\": {";
+
+			for (int i = 0; i < NUMBER_OF_TIMERS; ++i) {
+				json << (i > 0 ? ", " : "") << "\"" << statsTimerNames[i] << "\": {";
+
+				for (int event = 0; event < NUMBER_OF_PERF_EVENTS; ++event)
+					json << (event > 0 ? ", " : "") << "\"" << perfEventNames[event] << "\": " << perfCounts[i][event];
+
+				json << "}";
+			}
+
+			json << "}";
+		}
+
+		json << "}";
+		return json.str();
+	}
+};
+
+// Statistics are only gathered when asked for, so a normal solve just pays for checking this flag
+bool statsEnabled = false;
+bool statsAsJson = false;
+
+// Statistics of the threads that have finished, which hand theirs over as they exit
+SolveStats finishedThreadsStats;
+mutex finishedThreadsStatsMutex;
+
+// Each thread counts into its own statistics, so that the solver's threads don't contend on them
+class ThreadStats {
+public:
+	SolveStats stats;
+
+	ThreadStats() {};
+
+	~ThreadStats() {
+		lock_guard<mutex> lock(finishedThreadsStatsMutex);
+		finishedThreadsStats.add(stats);
+	}
+};
+
+SolveStats &threadStats() {
+	thread_local ThreadStats stats;
+	return stats.stats;
+}
+
+// The statistics of the calling thread and every thread that has finished
+SolveStats collectStats() {
+	lock_guard<mutex> lock(finishedThreadsStatsMutex);
+
+	SolveStats stats = finishedThreadsStats;
+	stats.add(threadStats());
+	return stats;
+}
+
+void printStats() {
+	SolveStats stats = collectStats();
+	cout << endl << (statsAsJson ? stats.toJson() : stats.toText()) << endl;
+}
+
+// Adds the time (and with --perf, the hardware events) until the end of its scope to a phase's timer
+class ScopedTimer {
+public:
+	StatsTimer timer;
+	bool enabled;
+	chrono::steady_clock::time_point start;
+	long long startPerfCounts[NUMBER_OF_PERF_EVENTS];
+
+	ScopedTimer(StatsTimer timer) {
+		this->timer = timer;
+		this->enabled = statsEnabled;
+
+		if (enabled) {
+			if (perfEnabled)
+				threadPerfCounters().read(startPerfCounts);
+
+			start = chrono::steady_clock::now();
+		}
+	}
+
+	~ScopedTimer() {
+		if (enabled) {
+			SolveStats &stats = threadStats();
+			stats.timerNanoseconds[timer] += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+			++stats.timerCalls[timer];
+
+			if (perfEnabled) {
+				long long perfCounts[NUMBER_OF_PERF_EVENTS];
+				threadPerfCounters().read(perfCounts);
+
+				for (int event = 0; event < NUMBER_OF_PERF_EVENTS; ++event)
+					stats.perfCounts[timer][event] += perfCounts[event] - startPerfCounts[event];
+			}
+		}
+	}
+};
+
+// Building with LNS_DISABLE_STATS defined removes every timer and counter from the solver
+#ifndef LNS_DISABLE_STATS
+#define STATS_CONCATENATE_(a, b) a##b
+#define STATS_CONCATENATE(a, b) STATS_CONCATENATE_(a, b)
+#define STATS_TIMER(timer) ScopedTimer STATS_CONCATENATE(scopedTimer, __LINE__)(timer)
+#define STATS_COUNT(counter) do { if (statsEnabled) ++threadStats().counters[counter]; } while (0)
+#define STATS_ADD(counter, amount) do { if (statsEnabled) threadStats().counters[counter] += (amount); } while (0)
+#else
+#define STATS_TIMER(timer) do {} while (0)
+#define STATS_COUNT(counter) do {} while (0)
+#define STATS_ADD(counter, amount) do {} while (0)
+#endif
+
 class Story {
 public:
 	int storyNumber, businessValue, storyPoints;
 	vector<int> dependencies;
 	vector<int> dependees;
 
+	// The story's ID in the data files, which can be any number (storyNumber is its position in the list of stories)
+	int storyId;
+
 	Story() {};
 
 	Story(int storyNumber, int businessValue, int storyPoints) {
 		this->storyNumber = storyNumber;
+		this->storyId = storyNumber;
 		this->businessValue = businessValue;
 		this->storyPoints = storyPoints;
 	}
 
 	Story(int storyNumber, int businessValue, int storyPoints, vector<int> dependencies) {
 		this->storyNumber = storyNumber;
+		this->storyId = storyNumber;
 		this->businessValue = businessValue;
 		this->storyPoints = storyPoints;
 		this->dependencies = dependencies;
@@ -128,731 +545,5461 @@ public:
 		return this->sprintNumber <= other.sprintNumber;
 	}
 
-	string toString() {
+	string toString() const {
 		return ">> Sprint " + to_string(sprintNumber) +
 			" (capacity: " + to_string(sprintCapacity) +
 			", bonus: " + to_string(sprintBonus) + ")";
 	}
 };
 
-class SprintDoublePairDescending {
+// Position of a sprint in a problem's list of sprints, or -1 for no sprint
+// (16 bits is plenty, and keeps the assignment arrays of very large problems small)
+typedef int16_t SprintPosition;
+
+// A contiguous run of story numbers, so that a story's dependencies can be looped over like a vector
+class StoryRange {
 public:
-	bool operator()(pair<Sprint, double> const& a, pair<Sprint, double> const& b) {
-		return a.second > b.second;
+	const int *first;
+	const int *last;
+
+	StoryRange(const int *first, const int *last) {
+		this->first = first;
+		this->last = last;
 	}
-};
 
-class StoryDoublePairDescending {
-public:
-	bool operator()(pair<Story, double> const& a, pair<Story, double> const& b) {
-		return a.second > b.second;
+	const int *begin() const {
+		return first;
 	}
-};
 
-class StoryGreedySorting {
-public:
-	bool operator()(Story const& a, Story const& b) {
-		if (a.businessValue > b.businessValue)
-			return true;
-		else if (a.businessValue == b.businessValue && a.storyPoints < b.storyPoints)
-			return true;
-		else if (a.businessValue == b.businessValue && a.storyPoints == b.storyPoints && a.dependencies.size() < b.dependencies.size())
-			return true;
-		else if (a.businessValue == b.businessValue && a.storyPoints == b.storyPoints && a.dependencies.size() == b.dependencies.size() && a.dependees.size() < b.dependees.size())
-			return true;
-		else
-			return false;
+	const int *end() const {
+		return last;
+	}
+
+	int size() const {
+		return last - first;
 	}
 };
 
-class Roadmap {
+// The parts of a problem's story data that what-if scenarios can't change: story IDs, story points and the dependency graph in compressed
+// sparse row form. Built once and shared by the base instance and every scenario of it
+class StoryGraph {
 public:
-	vector<Story> stories;
-	vector<Sprint> sprints;
-
-	map<Story, Sprint> storyToSprint;
-	map<Sprint, vector<Story>> sprintToStories;
+	vector<int> storyPoints; // Indexed by story number
 
-	Roadmap() {};
+	// The ID of each story in the data files, only needed to read and write them, and (ID, story number) pairs sorted by ID to look stories up
+	vector<int> storyIds;
+	vector<pair<int, int>> storyNumbersById;
 
-	Roadmap(vector<Story> stories, vector<Sprint> sprints) {
-		this->stories = stories;
-		this->sprints = sprints;
-	}
+	// The dependencies of story i are dependencyList[dependencyOffsets[i]] up to dependencyList[dependencyOffsets[i + 1]],
+	// and likewise for its dependees
+	vector<int> dependencyOffsets, dependencyList;
+	vector<int> dependeeOffsets, dependeeList;
 
-	bool validInsert(Story story, Sprint sprint) {
-		// Check if adding the story overloads the sprint
-		if (story.storyPoints + storyPointsAssignedToSprint(sprint) > sprint.sprintCapacity && sprint.sprintNumber != -1)
-			return false;
+	StoryGraph(const vector<Story> &storyData) {
+		dependencyOffsets.push_back(0);
+		dependeeOffsets.push_back(0);
 
-		// Check that no dependees are assigned earlier/same as the sprint
-		for (int dependeeNumber : story.dependees) {
-			Story dependee = stories[dependeeNumber];
+		for (const Story &story : storyData) {
+			storyPoints.push_back(story.storyPoints);
 
-			auto it = storyToSprint.find(dependee);
+			storyNumbersById.push_back(make_pair(story.storyId, (int)storyIds.size()));
+			storyIds.push_back(story.storyId);
 
-			// The dependee is assigned somewhere
-			if (it != storyToSprint.end()) {
-				Sprint dependeeAssignedSprint = it->second;
+			dependencyList.insert(dependencyList.end(), story.dependencies.begin(), story.dependencies.end());
+			dependencyOffsets.push_back(dependencyList.size());
 
-				// The dependee is assigned earlier/same as this sprint
-				if (dependeeAssignedSprint.sprintNumber <= sprint.sprintNumber && dependeeAssignedSprint.sprintNumber != -1)
-					return false;
-			}
+			dependeeList.insert(dependeeList.end(), story.dependees.begin(), story.dependees.end());
+			dependeeOffsets.push_back(dependeeList.size());
 		}
 
-		// Check that each of the story's dependencies are assigned before the sprint
-		for (int dependencyNumber : story.dependencies) {
-			Story dependency = stories[dependencyNumber];
+		sort(storyNumbersById.begin(), storyNumbersById.end());
+	}
 
-			auto it = storyToSprint.find(dependency);
+	// Approximate memory used by the graph, in bytes
+	size_t memoryUsage() const {
+		return sizeof(StoryGraph)
+			+ sizeof(int) * (storyPoints.capacity() + dependencyOffsets.capacity() + dependencyList.capacity() + dependeeOffsets.capacity() + dependeeList.capacity())
+			+ sizeof(int) * storyIds.capacity() + sizeof(pair<int, int>) * storyNumbersById.capacity();
+	}
+};
 
-			// Only stories that are assigned to a sprint are in the map
-			if (it == storyToSprint.end())
-				// The dependee isn't assigned to a sprint
-				return false;
+// Number of chunks the calling thread has had to take from the heap because their pool had none free (see ChunkPool)
+thread_local long long chunkHeapAllocations = 0;
 
-			Sprint dependencyAssignedSprint = it->second;
+// Free list of the memory blocks behind the chunks of a problem's assignment arrays. Roadmaps of the same problem copy chunks on write
+// and drop them again all the time, so recycling the blocks keeps the search loop from going back to the heap for every copy.
+// Chunks can be copied and dropped by any thread, so the list is locked
+class ChunkPool {
+public:
+	mutex poolMutex;
+	vector<void *> freeBlocks;
+	size_t blockSize;
 
-			// The dependee is assigned to the product backlog
-			if (dependencyAssignedSprint.sprintNumber == -1)
-				return false;
+	ChunkPool() {
+		this->blockSize = 0;
+	}
 
-			// The story is assigned to an earlier sprint than its dependee
-			if (sprint.sprintNumber <= dependencyAssignedSprint.sprintNumber)
-				return false;
-		}
+	ChunkPool(const ChunkPool&) = delete;
+	ChunkPool& operator = (const ChunkPool&) = delete;
 
-		// The sprint doesn't get overloaded and the story's dependencies are satisfied
-		return true;
+	~ChunkPool() {
+		for (void *block : freeBlocks)
+			::operator delete(block);
 	}
 
-	int storyPointsAssignedToSprint(Sprint sprint) {
-		vector<Story> sprintStories = sprintToStories[sprint];
+	void *allocate(size_t size) {
+		{
+			lock_guard<mutex> lock(poolMutex);
 
-		// Sum of the story points of all the stories assigned to the sprint
-		int assignedStoryPoints = 0;
+			// Every block holds a chunk and its shared_ptr bookkeeping, so they're all the same size
+			if (blockSize == 0)
+				blockSize = size;
 
-		for (Story story : sprintStories)
-			assignedStoryPoints += story.storyPoints;
+			if (size == blockSize && !freeBlocks.empty()) {
+				void *block = freeBlocks.back();
+				freeBlocks.pop_back();
+				return block;
+			}
+		}
 
-		return assignedStoryPoints;
+		++chunkHeapAllocations;
+		return ::operator new(size);
 	}
 
-	void addStoryToSprint(Story story, Sprint sprint) {
-		storyToSprint[story] = sprint;
-		sprintToStories[sprint].push_back(story);
+	void deallocate(void *block, size_t size) {
+		lock_guard<mutex> lock(poolMutex);
+
+		if (size == blockSize)
+			freeBlocks.push_back(block);
+		else
+			::operator delete(block);
 	}
 
-	void removeStoryFromSprint(Story story, Sprint sprint) {
-		storyToSprint.erase(storyToSprint.find(story));
-		sprintToStories[sprint].erase(remove(sprintToStories[sprint].begin(), sprintToStories[sprint].end(), story), sprintToStories[sprint].end());
+	// Adds blocks to the free list up front (once the size of a block is known from the first chunk)
+	void reserve(size_t blocks) {
+		lock_guard<mutex> lock(poolMutex);
+
+		if (blockSize == 0)
+			return;
+
+		freeBlocks.reserve(freeBlocks.size() + blocks);
+
+		for (size_t i = 0; i < blocks; ++i)
+			freeBlocks.push_back(::operator new(blockSize));
 	}
 
-	void moveStory(Story story, Sprint from, Sprint to) {
-		removeStoryFromSprint(story, from);
-		addStoryToSprint(story, to);
+	// Gives back to the heap up to that many free blocks
+	void release(size_t blocks) {
+		lock_guard<mutex> lock(poolMutex);
+
+		for (size_t i = 0; i < blocks && !freeBlocks.empty(); ++i) {
+			::operator delete(freeBlocks.back());
+			freeBlocks.pop_back();
+		}
 	}
+};
 
-	int calculateValue() {
-		int totalValue = 0;
+// Blocks set aside in a chunk pool for the roadmaps of a search while it runs. Every roadmap has at most a block per chunk to itself,
+// so with a block per chunk for each roadmap the search keeps alive, its chunks never run out however the roadmaps diverge
+// (other searches of the problem, and roadmaps kept from before, have blocks of their own)
+class ChunkReservation {
+public:
+	shared_ptr<ChunkPool> pool;
+	size_t blocks;
 
-		for (pair<Story, Sprint> pair : storyToSprint) {
-			Story story = pair.first;
-			Sprint sprint = pair.second;
+	ChunkReservation(shared_ptr<ChunkPool> pool, size_t blocks) {
+		this->pool = pool;
+		this->blocks = blocks;
 
-			// Don't add value from stories assigned to the product backlog
-			if (sprint.sprintNumber != -1)
-				totalValue += story.businessValue * sprint.sprintBonus;
-		}
+		pool->reserve(blocks);
+	}
 
-		return totalValue;
+	ChunkReservation(const ChunkReservation&) = delete;
+	ChunkReservation& operator = (const ChunkReservation&) = delete;
+
+	~ChunkReservation() {
+		pool->release(blocks);
 	}
+};
 
-	bool sprintCapacitiesSatisifed() {
-		for (pair<Sprint, vector<Story>> pair : sprintToStories) {
-			Sprint sprint = pair.first;
+// Standard library allocator handing out blocks from a chunk pool, which it keeps alive until every chunk it allocated is gone
+template <typename T>
+class ChunkAllocator {
+public:
+	typedef T value_type;
 
-			// Don't check the capacity of the product backlog
-			if (sprint.sprintNumber != -1) {
-				int assignedStoryPoints = storyPointsAssignedToSprint(sprint);
+	shared_ptr<ChunkPool> pool;
 
-				// Check if the sprint is overloaded
-				if (!sprint.withinCapacity(assignedStoryPoints))
-					// The story points assigned are not within the sprint's capacity
-					return false;
-			}
-		}
+	ChunkAllocator(shared_ptr<ChunkPool> pool) {
+		this->pool = pool;
+	}
 
-		// All sprints are within capacity
-		return true;
+	template <typename U>
+	ChunkAllocator(const ChunkAllocator<U>& other) {
+		this->pool = other.pool;
 	}
 
-	bool storyDependenciesSatisfied() {
-		for (pair<Story, Sprint> assignment : storyToSprint) {
-			Story story = assignment.first;
-			Sprint assignedSprint = assignment.second;
-
-			// Don't check stories assigned to the product backlog
-			if (assignedSprint.sprintNumber != -1) {
-				for (int dependeeNumber : story.dependencies) {
-					Story dependee = stories[dependeeNumber];
-					Sprint dependeeAssignedSprint = storyToSprint[dependee];
-
-					// Only stories that are assigned to a sprint are in the map
-					if (storyToSprint.find(dependee) == storyToSprint.end()) {
-						// The dependee isn't assigned to a sprint
-						return false;
-					} else if (dependeeAssignedSprint.sprintNumber == -1) {
-						// The dependee is assigned to the special product backlog
-						return false;
-					} else {
-						// Check where the story is assigned compared to its dependee
-						if (assignedSprint <= dependeeAssignedSprint)
-							// The story is assigned to an earlier sprint than its dependee
-							return false;
-					}
-				}
-			}
-		}
+	T *allocate(size_t n) {
+		return (T *)pool->allocate(n * sizeof(T));
+	}
 
-		// All stories have their dependees assigned to an earlier sprint
-		return true;
+	void deallocate(T *pointer, size_t n) {
+		pool->deallocate(pointer, n * sizeof(T));
 	}
 
-	bool isFeasible() {
-		return sprintCapacitiesSatisifed() && storyDependenciesSatisfied();
+	template <typename U>
+	bool operator == (const ChunkAllocator<U>& other) const {
+		return this->pool == other.pool;
 	}
 
-	string printStoryRoadmap() {
-		string outputString = "";
+	template <typename U>
+	bool operator != (const ChunkAllocator<U>& other) const {
+		return this->pool != other.pool;
+	}
+};
 
-		for (pair<Story, Sprint> pair : storyToSprint) {
-			Story story = pair.first;
-			Sprint sprint = pair.second;
+// The story and sprint data of a problem, built once and then shared read-only by every roadmap of the problem.
+// The fields are flat arrays (struct-of-arrays), so the instance costs a few bytes per story and dependency rather than a pair of vectors per story.
+// Copies (what-if scenarios) share the story graph and only have their own values and sprints
+class ProblemInstance {
+public:
+	int numberOfStories;
+	vector<int> storyValues; // Indexed by story number
 
-			outputString += story.toString() + "\n  >> " + sprint.toString() + "\n";
-		}
+	shared_ptr<const StoryGraph> graph;
 
-		return outputString;
-	}
+	vector<Sprint> sprints;
+	vector<int> sprintNumbers, sprintCapacities; // Indexed by position in sprints (the product backlog has no capacity limit)
 
-	string printSprintRoadmap() {
-		string outputString = "";
+	// The bonus of each sprint shifted along by one position, so that unassigned stories (sprint position -1) get a bonus of 0
+	vector<int> sprintBonusLookup;
 
-		for (Sprint sprint : sprints) {
-			vector<Story> sprintStories = sprintToStories[sprint];
+	// Position in sprints of the special sprint representing the product backlog
+	int backlogSprint;
 
-			if (!sprintStories.empty()) {
-				if (sprint.sprintNumber == -1)
-					outputString += "Product Backlog";
-				else
-					outputString += sprint.toString();
+	// Largest capacity of any real sprint
+	int maxSprintCapacity;
 
-				int valueDelivered = 0;
-				int storyPointsAssigned = 0;
+	// Where the roadmaps of the problem get their assignment chunks from (the one part of the instance that changes, and it locks itself)
+	shared_ptr<ChunkPool> chunkPool;
 
-				for (Story story : sprintStories) {
-					valueDelivered += story.businessValue;
-					storyPointsAssigned += story.storyPoints;
+	ProblemInstance(const vector<Story> &storyData, const vector<Sprint> &sprintData) {
+		if (sprintData.size() > INT16_MAX)
+			throw runtime_error("Too many sprints, there can be at most " + to_string(INT16_MAX));
 
-					outputString += "\n\t" + story.toString();
-				}
+		this->numberOfStories = storyData.size();
+		this->sprints = sprintData;
+		this->backlogSprint = -1;
+		this->maxSprintCapacity = 0;
+		this->graph = make_shared<const StoryGraph>(storyData);
+		this->chunkPool = make_shared<ChunkPool>();
 
-				outputString += "\n-- [Value: " + to_string(valueDelivered)
-					+ " (weighted value: " + to_string(valueDelivered * sprint.sprintBonus) + "), "
-					+ "story points: " + to_string(storyPointsAssigned) + "]";
+		for (const Story &story : storyData)
+			storyValues.push_back(story.businessValue);
 
-				outputString += "\n\n";
+		sprintBonusLookup.push_back(0);
+
+		for (int i = 0; i < sprints.size(); ++i) {
+			sprintNumbers.push_back(sprints[i].sprintNumber);
+
+			// Stories in the product backlog don't deliver any value
+			if (sprints[i].sprintNumber == -1) {
+				backlogSprint = i;
+				sprintCapacities.push_back(INT_MAX);
+				sprintBonusLookup.push_back(0);
+			}
+			else {
+				sprintCapacities.push_back(sprints[i].sprintCapacity);
+				sprintBonusLookup.push_back(sprints[i].sprintBonus);
+				maxSprintCapacity = max(maxSprintCapacity, sprints[i].sprintCapacity);
 			}
 		}
+	}
 
-		return outputString;
+	int numberOfSprints() const {
+		return sprints.size();
 	}
-};
 
-// Returns a random position in the input vector according to the given probability distribution of getting each position
-int randomIntDiscreteDistribution(vector<double> probabilities) {
-	// Randomly generated percentage
-	double randomPercentage = (double)(rand() % 1024) / 1024;
+	// Bonus of the sprint at the given position (0 for the product backlog and for unassigned stories)
+	int sprintBonus(int sprint) const {
+		return sprintBonusLookup[sprint + 1];
+	}
 
-	// Threshold representing the upper limit of each probability band
-	double threshold = probabilities[0];
+	// Number of the story with the given ID, or -1 if there isn't one
+	int storyNumberOf(int storyId) const {
+		const vector<pair<int, int>> &storyNumbersById = graph->storyNumbersById;
 
-	for (int i = 0; i < probabilities.size(); ++i) {
-		// If the random percentage is within this vector position's probability threshold, return the position
-		if (randomPercentage < threshold)
-			return i;
-		else
-			// If not, extend the threshold to the next probability band
-			threshold += probabilities[i + 1];
+		auto story = lower_bound(storyNumbersById.begin(), storyNumbersById.end(), make_pair(storyId, INT_MIN));
+		return story != storyNumbersById.end() && story->first == storyId ? story->second : -1;
 	}
-}
 
-// Uses the parametric equation of a geometric sequence to return a vector of doubles
-vector<double> geometricSequence(double a, double r, double n) {
-	vector<double> sequence;
+	// Position in sprints of the sprint with the given number (the product backlog is -1), or -1 if there isn't one
+	int sprintPosition(int sprintNumber) const {
+		int sprint = find(sprintNumbers.begin(), sprintNumbers.end(), sprintNumber) - sprintNumbers.begin();
+		return sprint < sprintNumbers.size() ? sprint : -1;
+	}
 
-	for (int i = 0; i < n; ++i) {
-		sequence.push_back(a * pow(r, i));
+	StoryRange dependencies(int storyNumber) const {
+		return StoryRange(graph->dependencyList.data() + graph->dependencyOffsets[storyNumber], graph->dependencyList.data() + graph->dependencyOffsets[storyNumber + 1]);
 	}
 
-	return sequence;
-}
+	StoryRange dependees(int storyNumber) const {
+		return StoryRange(graph->dependeeList.data() + graph->dependeeOffsets[storyNumber], graph->dependeeList.data() + graph->dependeeOffsets[storyNumber + 1]);
+	}
 
-// Represents moving a story from/to a sprint
-class Move {
-public:
-	Story story;
-	Sprint sprint;
+	// A hash of everything that affects the solutions (FNV-1a), to tell whether a saved search was of the same problem
+	unsigned long long fingerprint() const {
+		unsigned long long hash = 14695981039346656037ULL;
 
-	Move() {};
+		auto addValues = [&hash](const vector<int> &values) {
+			for (int value : values) {
+				hash ^= (unsigned int)value;
+				hash *= 1099511628211ULL;
+			}
+		};
 
-	Move(Story story, Sprint sprint) {
-		this->story = story;
-		this->sprint = sprint;
-	}
+		addValues(storyValues);
+		addValues(graph->storyPoints);
+		addValues(graph->dependencyOffsets);
+		addValues(graph->dependencyList);
+		addValues(sprintNumbers);
+		addValues(sprintCapacities);
+		addValues(sprintBonusLookup);
 
-	bool operator == (const Move& other) const {
-		return this->story == other.story && this->sprint == other.sprint;
+		return hash;
 	}
 
-	bool operator < (const Move& other) const {
-		if (this->story < other.story)
-			return true;
-		else if (this->story == other.story && this->sprint < other.sprint)
-			return true;
+	// Changes a story's value or a sprint's capacity or bonus, to turn a copy of the instance into a what-if scenario of it
+	// (only before any roadmap uses the instance, as roadmaps keep sprint loads that assume it never changes)
+	void applyOverride(const string &target, int number, const string &field, int value) {
+		if (target == "story") {
+			int storyNumber = storyNumberOf(number);
+
+			if (storyNumber == -1)
+				throw runtime_error("Unknown story " + to_string(number));
+
+			if (field != "value")
+				throw runtime_error("Stories can only have their value changed, not their " + field);
+
+			storyValues[storyNumber] = value;
+			return;
+		}
+
+		if (target != "sprint")
+			throw runtime_error("Unknown scenario target " + target + " (expected story or sprint)");
+
+		int sprint = sprintPosition(number);
+
+		if (number == -1 || sprint == -1)
+			throw runtime_error("Unknown sprint " + to_string(number));
+
+		if (field == "capacity") {
+			sprints[sprint].sprintCapacity = value;
+			sprintCapacities[sprint] = value;
+
+			maxSprintCapacity = 0;
+
+			for (int i = 0; i < sprints.size(); ++i) {
+				if (i != backlogSprint)
+					maxSprintCapacity = max(maxSprintCapacity, sprintCapacities[i]);
+			}
+		}
+		else if (field == "bonus") {
+			sprints[sprint].sprintBonus = value;
+			sprintBonusLookup[sprint + 1] = value;
+		}
 		else
-			return false;
+			throw runtime_error("Sprints can only have their capacity or bonus changed, not their " + field);
+	}
+
+	// Rebuilds the story as a Story object for printing, numbered by ID like in the data files
+	Story story(int storyNumber) const {
+		vector<int> dependencyIds;
+
+		for (int dependencyNumber : dependencies(storyNumber))
+			dependencyIds.push_back(graph->storyIds[dependencyNumber]);
+
+		return Story(graph->storyIds[storyNumber], storyValues[storyNumber], graph->storyPoints[storyNumber], dependencyIds);
+	}
+
+	// Approximate memory used by the instance (counting the story graph in full, though scenarios share it), in bytes
+	size_t memoryUsage() const {
+		return sizeof(ProblemInstance) + graph->memoryUsage() + sizeof(int) * storyValues.capacity()
+			+ (sizeof(Sprint) + 3 * sizeof(int)) * sprints.size();
 	}
 };
 
-// A partly-destroyed solution, a list of the stories that were removed, and the moves that removed them
-class DestroyedRoadmap {
+class SprintDoublePairDescending {
 public:
-	Roadmap roadmap;
-	vector<Story> removedStories;
-	vector<Move> moves;
+	bool operator()(pair<Sprint, double> const& a, pair<Sprint, double> const& b) {
+		return a.second > b.second;
+	}
+};
 
-	DestroyedRoadmap() {};
+class StoryDoublePairDescending {
+public:
+	bool operator()(pair<Story, double> const& a, pair<Story, double> const& b) {
+		return a.second > b.second;
+	}
+};
 
-	DestroyedRoadmap(Roadmap roadmap, vector<Story> removedStories, vector<Move> moves) {
-		this->roadmap = roadmap;
-		this->removedStories = removedStories;
-		this->moves = moves;
+class StoryGreedySorting {
+public:
+	// The problem the stories belong to, when sorting story numbers rather than Story objects
+	const ProblemInstance *instance;
+
+	StoryGreedySorting() {
+		this->instance = NULL;
+	}
+
+	StoryGreedySorting(const ProblemInstance *instance) {
+		this->instance = instance;
+	}
+
+	bool operator()(int a, int b) {
+		int aValue = instance->storyValues[a], bValue = instance->storyValues[b];
+		int aPoints = instance->graph->storyPoints[a], bPoints = instance->graph->storyPoints[b];
+
+		if (aValue != bValue)
+			return aValue > bValue;
+		else if (aPoints != bPoints)
+			return aPoints < bPoints;
+		else if (instance->dependencies(a).size() != instance->dependencies(b).size())
+			return instance->dependencies(a).size() < instance->dependencies(b).size();
+		else
+			return instance->dependees(a).size() < instance->dependees(b).size();
+	}
+
+	bool operator()(Story const& a, Story const& b) {
+		if (a.businessValue > b.businessValue)
+			return true;
+		else if (a.businessValue == b.businessValue && a.storyPoints < b.storyPoints)
+			return true;
+		else if (a.businessValue == b.businessValue && a.storyPoints == b.storyPoints && a.dependencies.size() < b.dependencies.size())
+			return true;
+		else if (a.businessValue == b.businessValue && a.storyPoints == b.storyPoints && a.dependencies.size() == b.dependencies.size() && a.dependees.size() < b.dependees.size())
+			return true;
+		else
+			return false;
 	}
 };
 
-// A repaired solution and the list of moves that repaired it
-class RepairedRoadmap {
+// The sprint positions of a roadmap's stories, split into fixed-size chunks that copies of the array share until one of them writes to
+// a chunk (copy-on-write). Copying a roadmap then copies a pointer per chunk rather than every assignment, and a copy that goes on to
+// move a few stories only duplicates the chunks they're in. Chunks come from the problem's ChunkPool
+class AssignmentArray {
 public:
-	Roadmap roadmap;
-	vector<Move> moves;
+	static constexpr int chunkShift = 8;
+	static constexpr int chunkSize = 1 << chunkShift; // 256 stories, half a KB
 
-	RepairedRoadmap() {};
+	class Chunk {
+	public:
+		SprintPosition sprints[chunkSize];
+	};
 
-	RepairedRoadmap(Roadmap roadmap, vector<Move> moves) {
-		this->roadmap = roadmap;
-		this->moves = moves;
+	vector<shared_ptr<Chunk>> chunks;
+	int numberOfStories;
+
+	AssignmentArray() {
+		this->numberOfStories = 0;
+	}
+
+	void assign(int numberOfStories, SprintPosition sprint, const shared_ptr<ChunkPool> &pool) {
+		this->numberOfStories = numberOfStories;
+
+		chunks.clear();
+
+		for (int first = 0; first < numberOfStories; first += chunkSize) {
+			chunks.push_back(allocate_shared<Chunk>(ChunkAllocator<Chunk>(pool)));
+			fill(chunks.back()->sprints, chunks.back()->sprints + chunkSize, sprint);
+		}
+	}
+
+	int size() const {
+		return numberOfStories;
+	}
+
+	SprintPosition operator[](int storyNumber) const {
+		return chunks[storyNumber >> chunkShift]->sprints[storyNumber & (chunkSize - 1)];
+	}
+
+	void set(int storyNumber, SprintPosition sprint, const shared_ptr<ChunkPool> &pool) {
+		shared_ptr<Chunk> &chunk = chunks[storyNumber >> chunkShift];
+
+		// Another roadmap can still see the chunk, so this one gets its own copy first
+		// (only copies of this roadmap could share it, so the count can't go up behind our back)
+		if (chunk.use_count() > 1)
+			chunk = allocate_shared<Chunk>(ChunkAllocator<Chunk>(pool), *chunk);
+
+		chunk->sprints[storyNumber & (chunkSize - 1)] = sprint;
+	}
+
+	// The assignments of the stories from chunk * chunkSize, stored contiguously, and how many of them there are
+	const SprintPosition *chunkData(int chunk) const {
+		return chunks[chunk]->sprints;
+	}
+
+	int chunkLength(int chunk) const {
+		return min(chunkSize, numberOfStories - chunk * chunkSize);
+	}
+
+	int numberOfChunks() const {
+		return chunks.size();
+	}
+
+	vector<SprintPosition> toVector() const {
+		vector<SprintPosition> sprints;
+		sprints.reserve(numberOfStories);
+
+		for (int chunk = 0; chunk < numberOfChunks(); ++chunk)
+			sprints.insert(sprints.end(), chunkData(chunk), chunkData(chunk) + chunkLength(chunk));
+
+		return sprints;
+	}
+
+	// Memory used by the array, in bytes (counting chunks shared with other roadmaps in full)
+	size_t memoryUsage() const {
+		return sizeof(shared_ptr<Chunk>) * chunks.capacity() + sizeof(Chunk) * chunks.size();
 	}
 };
 
-// A Tabu list holding the banned moves
-class TabuList {
+// Roadmap kernels //////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+
+// Whether the CPU (and the operating system, which has to save the wider registers) supports AVX2
+bool cpuHasAvx2() {
+#if defined(LNS_AVX2_KERNELS) && defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+
+	bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+	bool avx = (info[2] & (1 << 28)) != 0;
+
+	__cpuidex(info, 7, 0);
+	return osSavesYmm && avx && (info[1] & (1 << 5)) != 0;
+#elif defined(LNS_AVX2_KERNELS)
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#else
+	return false;
+#endif
+}
+
+const bool useAvx2Kernels = cpuHasAvx2();
+
+// Sum of business value * sprint bonus over a run of stories, where bonuses is indexed by sprint position
+int valueKernel(const int *values, const SprintPosition *assigned, const int *bonuses, int numberOfStories) {
+	int totalValue = 0;
+
+	for (int i = 0; i < numberOfStories; ++i)
+		totalValue += values[i] * bonuses[assigned[i]];
+
+	return totalValue;
+}
+
+// Whether every load is within its capacity
+bool withinCapacitiesKernel(const int *loads, const int *capacities, int numberOfSprints) {
+	for (int sprint = 0; sprint < numberOfSprints; ++sprint) {
+		if (loads[sprint] > capacities[sprint])
+			return false;
+	}
+
+	return true;
+}
+
+#ifdef LNS_AVX2_KERNELS
+AVX2_TARGET int valueKernelAvx2(const int *values, const SprintPosition *assigned, const int *bonuses, int numberOfStories) {
+	__m256i sums = _mm256_setzero_si256();
+	int i = 0;
+
+	// Eight stories at a time: gather each story's sprint bonus and multiply-accumulate with its business value
+	for (; i + 8 <= numberOfStories; i += 8) {
+		__m256i sprintPositions = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(assigned + i)));
+		__m256i storyBonuses = _mm256_i32gather_epi32(bonuses, sprintPositions, 4);
+		__m256i businessValues = _mm256_loadu_si256((const __m256i *)(values + i));
+
+		sums = _mm256_add_epi32(sums, _mm256_mullo_epi32(businessValues, storyBonuses));
+	}
+
+	int lanes[8];
+	_mm256_storeu_si256((__m256i *)lanes, sums);
+
+	int totalValue = valueKernel(values + i, assigned + i, bonuses, numberOfStories - i);
+
+	for (int lane : lanes)
+		totalValue += lane;
+
+	return totalValue;
+}
+
+AVX2_TARGET bool withinCapacitiesKernelAvx2(const int *loads, const int *capacities, int numberOfSprints) {
+	__m256i overloaded = _mm256_setzero_si256();
+	int sprint = 0;
+
+	// Compare eight sprints' loads against their capacities at a time
+	for (; sprint + 8 <= numberOfSprints; sprint += 8) {
+		__m256i sprintLoads = _mm256_loadu_si256((const __m256i *)(loads + sprint));
+		__m256i sprintCapacities = _mm256_loadu_si256((const __m256i *)(capacities + sprint));
+
+		overloaded = _mm256_or_si256(overloaded, _mm256_cmpgt_epi32(sprintLoads, sprintCapacities));
+	}
+
+	if (!_mm256_testz_si256(overloaded, overloaded))
+		return false;
+
+	return withinCapacitiesKernel(loads + sprint, capacities + sprint, numberOfSprints - sprint);
+}
+#endif
+
+// Building with LNS_VERIFY defined shadows every change to a roadmap with a ReferenceRoadmap, and checks every verifyInterval-th change,
+// value, feasibility check and insert check against it. The first disagreement stops the program, whether or not asserts are on
+#ifdef LNS_VERIFY
+long long verifyInterval = 1;
+
+bool verifySample() {
+	thread_local long long checks = 0;
+	return ++checks % verifyInterval == 0;
+}
+
+void verificationFailed(const string &check) {
+	cerr << "Verification failed: " << check << endl;
+	abort();
+}
+#endif
+
+// The roadmap operations written the simple way, over a plain array of assignments and the instance's Sprint objects, without Roadmap's
+// cached loads and violation counts or its chunked and vectorised loops. Roadmap is checked against it by the verification build
+// (LNS_VERIFY) and the fuzz tester (--fuzz)
+class ReferenceRoadmap {
 public:
-	map<Move, int> tabuList;
-	int tenure;
+	shared_ptr<const ProblemInstance> instance;
+	vector<int> assignedSprints;
 
-	TabuList(int tenure) {
-		this->tenure = tenure;
+	ReferenceRoadmap() {};
+
+	ReferenceRoadmap(shared_ptr<const ProblemInstance> instance) {
+		this->instance = instance;
+
+		assignedSprints.assign(instance->numberOfStories, -1);
 	}
 
-	void add(Move move, int currentIteration) {
-		// Store the iteration when the move became tabu
-		tabuList[move] = currentIteration;
+	// Sprint -1 unassigns the story
+	void assign(int storyNumber, int sprint) {
+		assignedSprints[storyNumber] = sprint;
 	}
 
-	bool isTabu(Move move, int currentIteration) {
-		map<Move, int>::iterator movePositionIterator = tabuList.find(move);
-
-		// Check if the move is in the map
-		if (movePositionIterator != tabuList.end()) {
-			// The move is in the map, check if its tenure is over
-			if (currentIteration - tenure > tabuList[move]) {
-				// The move's tenure has expired so it's not tabu - remove it from the map and return
-				tabuList.erase(movePositionIterator);
-				return false;
-			}
-			else {
-				// The move is tabu
-				return true;
+	bool isInRealSprint(int storyNumber) const {
+		return assignedSprints[storyNumber] != -1 && instance->sprints[assignedSprints[storyNumber]].sprintNumber != -1;
+	}
+
+	int calculateValue() const {
+		int totalValue = 0;
+
+		for (int storyNumber = 0; storyNumber < assignedSprints.size(); ++storyNumber) {
+			if (assignedSprints[storyNumber] != -1)
+				totalValue += instance->storyValues[storyNumber] * instance->sprints[assignedSprints[storyNumber]].sprintBonus;
+		}
+
+		return totalValue;
+	}
+
+	vector<int> sprintLoads() const {
+		vector<int> loads(instance->sprints.size(), 0);
+
+		for (int storyNumber = 0; storyNumber < assignedSprints.size(); ++storyNumber) {
+			if (assignedSprints[storyNumber] != -1)
+				loads[assignedSprints[storyNumber]] += instance->graph->storyPoints[storyNumber];
+		}
+
+		return loads;
+	}
+
+	int overloadedSprints() const {
+		vector<int> loads = sprintLoads();
+		int overloaded = 0;
+
+		for (int sprint = 0; sprint < instance->sprints.size(); ++sprint) {
+			if (instance->sprints[sprint].sprintNumber != -1 && loads[sprint] > instance->sprints[sprint].sprintCapacity)
+				++overloaded;
+		}
+
+		return overloaded;
+	}
+
+	// Number of (story, dependency) pairs where the story is in a sprint and the dependency isn't in an earlier one
+	int precedenceViolations() const {
+		int violations = 0;
+
+		for (int storyNumber = 0; storyNumber < assignedSprints.size(); ++storyNumber) {
+			if (!isInRealSprint(storyNumber))
+				continue;
+
+			for (int dependencyNumber : instance->dependencies(storyNumber)) {
+				if (!isInRealSprint(dependencyNumber)
+					|| instance->sprints[assignedSprints[storyNumber]].sprintNumber <= instance->sprints[assignedSprints[dependencyNumber]].sprintNumber)
+					++violations;
 			}
 		}
-		else {
-			// It's not in the map so it's not tabu
+
+		return violations;
+	}
+
+	bool isFeasible() const {
+		return overloadedSprints() == 0 && precedenceViolations() == 0;
+	}
+
+	// Whether the story fits in the sprint on top of what's there, every story that depends on it is in a later sprint (or none),
+	// and everything it depends on is in an earlier sprint
+	bool validInsert(int storyNumber, int sprint) const {
+		const Sprint &target = instance->sprints[sprint];
+
+		if (target.sprintNumber != -1 && sprintLoads()[sprint] + instance->graph->storyPoints[storyNumber] > target.sprintCapacity)
 			return false;
+
+		for (int otherNumber = 0; otherNumber < assignedSprints.size(); ++otherNumber) {
+			StoryRange otherDependencies = instance->dependencies(otherNumber);
+
+			if (isInRealSprint(otherNumber) && find(otherDependencies.begin(), otherDependencies.end(), storyNumber) != otherDependencies.end()
+				&& instance->sprints[assignedSprints[otherNumber]].sprintNumber <= target.sprintNumber)
+				return false;
+		}
+
+		for (int dependencyNumber : instance->dependencies(storyNumber)) {
+			if (!isInRealSprint(dependencyNumber) || target.sprintNumber <= instance->sprints[assignedSprints[dependencyNumber]].sprintNumber)
+				return false;
 		}
+
+		return true;
 	}
 };
 
-// Implements the Large Neighbourhood search algorithm
-class LNS {
+class Roadmap {
 public:
-	LNS() {};
+	// The problem this roadmap is a solution to, shared by every roadmap of the problem
+	shared_ptr<const ProblemInstance> instance;
 
-	/*
-	// Adapted from:
-	// GeeksforGeeks. (2018). Breadth First Search or BFS for a Graph - GeeksforGeeks. [online] Available at: https://www.geeksforgeeks.org/breadth-first-search-or-bfs-for-a-graph/ [Accessed 9 Dec. 2018].
-	*/
-	// Adds stories to the list of removed stories by traversing the dependency graph in breadth-first order
-	static vector<Story> traverseDependenciesBF(Story story, Roadmap roadmap, vector<Story> removedStories, int numberOfStoriesToRemove) {
-		bool *visited = new bool[roadmap.stories.size()];
+	// Position in the instance's sprints of the sprint that each story is assigned to, or -1 if the story isn't assigned anywhere
+	AssignmentArray assignedSprints;
+
+	// Story points assigned to each sprint, kept up to date as stories are added and removed
+	vector<int> sprintLoads;
+
+	// Number of sprints over capacity and number of dependencies not assigned to an earlier sprint than the stories
+	// that need them, kept up to date as stories are added and removed so that checking feasibility is O(1)
+	int overloadedSprints;
+	int precedenceViolations;
+
+#ifdef LNS_VERIFY
+	// The same roadmap kept the simple way, to check this one against
+	ReferenceRoadmap shadow;
+#endif
+
+	Roadmap() {
+		this->overloadedSprints = 0;
+		this->precedenceViolations = 0;
+	};
+
+	Roadmap(shared_ptr<const ProblemInstance> instance) {
+		this->instance = instance;
+		this->overloadedSprints = 0;
+		this->precedenceViolations = 0;
+
+		assignedSprints.assign(instance->numberOfStories, -1, instance->chunkPool);
+		sprintLoads.assign(instance->numberOfSprints(), 0);
+
+#ifdef LNS_VERIFY
+		shadow = ReferenceRoadmap(instance);
+#endif
+	}
+
+	int numberOfStories() const {
+		return assignedSprints.size();
+	}
+
+	int numberOfSprints() const {
+		return sprintLoads.size();
+	}
+
+	int backlogSprint() const {
+		return instance->backlogSprint;
+	}
+
+	bool validInsert(int storyNumber, int sprint) {
+		bool valid = checkInsert(storyNumber, sprint);
+
+#ifdef LNS_VERIFY
+		if (verifySample() && valid != shadow.validInsert(storyNumber, sprint))
+			verificationFailed("validInsert of story " + to_string(storyNumber) + " into sprint " + to_string(sprint));
+#endif
+
+		return valid;
+	}
+
+	bool checkInsert(int storyNumber, int sprint) {
+		STATS_COUNT(COUNTER_VALID_INSERTS);
+
+		const ProblemInstance &problem = *instance;
+
+		// Check if adding the story overloads the sprint
+		if (sprint != problem.backlogSprint && problem.graph->storyPoints[storyNumber] + sprintLoads[sprint] > problem.sprintCapacities[sprint])
+			return false;
+
+		// Check that no dependees are assigned earlier/same as the sprint
+		for (int dependeeNumber : problem.dependees(storyNumber)) {
+			int dependeeSprint = assignedSprints[dependeeNumber];
+
+			// The dependee is assigned to a sprint earlier/same as this sprint
+			if (dependeeSprint != -1 && dependeeSprint != problem.backlogSprint && problem.sprintNumbers[dependeeSprint] <= problem.sprintNumbers[sprint])
+				return false;
+		}
+
+		// Check that each of the story's dependencies are assigned before the sprint
+		for (int dependencyNumber : problem.dependencies(storyNumber)) {
+			int dependencySprint = assignedSprints[dependencyNumber];
+
+			// The dependency isn't assigned to a sprint, or is assigned to the product backlog
+			if (dependencySprint == -1 || dependencySprint == problem.backlogSprint)
+				return false;
+
+			// The story is assigned to an earlier sprint than its dependency
+			if (problem.sprintNumbers[sprint] <= problem.sprintNumbers[dependencySprint])
+				return false;
+		}
+
+		// The sprint doesn't get overloaded and the story's dependencies are satisfied
+		return true;
+	}
+
+	int storyPointsAssignedToSprint(int sprint) {
+		return sprintLoads[sprint];
+	}
+
+	bool isAssigned(int storyNumber) {
+		return assignedSprints[storyNumber] != -1;
+	}
+
+	// Whether the story is assigned to a sprint other than the product backlog
+	bool isInRealSprint(int storyNumber) {
+		return assignedSprints[storyNumber] != -1 && assignedSprints[storyNumber] != instance->backlogSprint;
+	}
+
+	// Whether the dependency between the stories is broken: the dependent story is in a sprint, and the story it depends on
+	// isn't in an earlier one
+	bool isPrecedenceViolated(int dependentNumber, int dependencyNumber) {
+		if (!isInRealSprint(dependentNumber))
+			return false;
+
+		if (!isInRealSprint(dependencyNumber))
+			return true;
+
+		return instance->sprintNumbers[assignedSprints[dependentNumber]] <= instance->sprintNumbers[assignedSprints[dependencyNumber]];
+	}
+
+	// Number of broken dependencies involving the story, which are the only ones that change when the story moves
+	int storyPrecedenceViolations(int storyNumber) {
+		int violations = 0;
+
+		for (int dependencyNumber : instance->dependencies(storyNumber))
+			violations += isPrecedenceViolated(storyNumber, dependencyNumber);
+
+		for (int dependeeNumber : instance->dependees(storyNumber))
+			violations += isPrecedenceViolated(dependeeNumber, storyNumber);
+
+		return violations;
+	}
+
+	bool isOverloaded(int sprint) {
+		return sprint != instance->backlogSprint && sprintLoads[sprint] > instance->sprintCapacities[sprint];
+	}
+
+	void addStoryToSprint(int storyNumber, int sprint) {
+		precedenceViolations -= storyPrecedenceViolations(storyNumber);
+		overloadedSprints -= isOverloaded(sprint);
+
+		assignedSprints.set(storyNumber, sprint, instance->chunkPool);
+		sprintLoads[sprint] += instance->graph->storyPoints[storyNumber];
+
+		precedenceViolations += storyPrecedenceViolations(storyNumber);
+		overloadedSprints += isOverloaded(sprint);
+
+#ifdef LNS_VERIFY
+		shadow.assign(storyNumber, sprint);
+
+		if (verifySample())
+			verify();
+#endif
+	}
+
+	void removeStoryFromSprint(int storyNumber) {
+		int sprint = assignedSprints[storyNumber];
+
+		precedenceViolations -= storyPrecedenceViolations(storyNumber);
+		overloadedSprints -= isOverloaded(sprint);
+
+		sprintLoads[sprint] -= instance->graph->storyPoints[storyNumber];
+		assignedSprints.set(storyNumber, -1, instance->chunkPool);
+
+		precedenceViolations += storyPrecedenceViolations(storyNumber);
+		overloadedSprints += isOverloaded(sprint);
+
+#ifdef LNS_VERIFY
+		shadow.assign(storyNumber, -1);
+
+		if (verifySample())
+			verify();
+#endif
+	}
+
+#ifdef LNS_VERIFY
+	// Checks the assignments, loads and counts of violations kept up to date as stories move against the shadow's
+	void verify() {
+		for (int storyNumber = 0; storyNumber < assignedSprints.size(); ++storyNumber) {
+			if (assignedSprints[storyNumber] != shadow.assignedSprints[storyNumber])
+				verificationFailed("assignment of story " + to_string(storyNumber));
+		}
+
+		if (sprintLoads != shadow.sprintLoads())
+			verificationFailed("sprint loads");
+
+		if (overloadedSprints != shadow.overloadedSprints())
+			verificationFailed("count of overloaded sprints");
+
+		if (precedenceViolations != shadow.precedenceViolations())
+			verificationFailed("count of precedence violations");
+	}
+#endif
+
+	void moveStory(int storyNumber, int to) {
+		removeStoryFromSprint(storyNumber);
+		addStoryToSprint(storyNumber, to);
+	}
+
+	// Returns the numbers of the stories assigned to the sprint, in story number order
+	vector<int> storiesInSprint(int sprint) {
+		vector<int> sprintStories;
+
+		for (int storyNumber = 0; storyNumber < assignedSprints.size(); ++storyNumber) {
+			if (assignedSprints[storyNumber] == sprint)
+				sprintStories.push_back(storyNumber);
+		}
+
+		return sprintStories;
+	}
+
+	// Sum of business value * sprint bonus over every assigned story
+	int calculateValue() {
+		const int *bonuses = instance->sprintBonusLookup.data() + 1; // Unassigned stories look up position -1
+		int totalValue = 0;
+
+		for (int chunk = 0; chunk < assignedSprints.numberOfChunks(); ++chunk) {
+			const int *values = instance->storyValues.data() + chunk * AssignmentArray::chunkSize;
+			const SprintPosition *assigned = assignedSprints.chunkData(chunk);
+			int numberOfStories = assignedSprints.chunkLength(chunk);
+
+#ifdef LNS_AVX2_KERNELS
+			if (useAvx2Kernels) {
+				totalValue += valueKernelAvx2(values, assigned, bonuses, numberOfStories);
+				continue;
+			}
+#endif
+
+			totalValue += valueKernel(values, assigned, bonuses, numberOfStories);
+		}
+
+#ifdef LNS_VERIFY
+		if (verifySample() && totalValue != shadow.calculateValue())
+			verificationFailed("value");
+#endif
+
+		return totalValue;
+	}
+
+	// Recounts the story points assigned to each sprint from scratch (a histogram of the assignments)
+	vector<int> calculateSprintLoads() {
+		int numberOfSprints = sprintLoads.size();
+
+		// Four interleaved histograms, so that consecutive stories in the same sprint don't wait on each other's updates.
+		// Each histogram has a slot in front for unassigned stories
+		vector<int> histograms(4 * (numberOfSprints + 1), 0);
+		int *histogram[4];
+
+		for (int h = 0; h < 4; ++h)
+			histogram[h] = histograms.data() + h * (numberOfSprints + 1) + 1;
+
+		for (int chunk = 0; chunk < assignedSprints.numberOfChunks(); ++chunk) {
+			const int *points = instance->graph->storyPoints.data() + chunk * AssignmentArray::chunkSize;
+			const SprintPosition *assigned = assignedSprints.chunkData(chunk);
+			int numberOfStories = assignedSprints.chunkLength(chunk);
+			int i = 0;
+
+			for (; i + 4 <= numberOfStories; i += 4) {
+				histogram[0][assigned[i]] += points[i];
+				histogram[1][assigned[i + 1]] += points[i + 1];
+				histogram[2][assigned[i + 2]] += points[i + 2];
+				histogram[3][assigned[i + 3]] += points[i + 3];
+			}
+
+			for (; i < numberOfStories; ++i)
+				histogram[0][assigned[i]] += points[i];
+		}
+
+		vector<int> loads(numberOfSprints);
+
+		for (int sprint = 0; sprint < numberOfSprints; ++sprint)
+			loads[sprint] = histogram[0][sprint] + histogram[1][sprint] + histogram[2][sprint] + histogram[3][sprint];
+
+		return loads;
+	}
+
+	bool sprintCapacitiesSatisifed() {
+		// Recount rather than trusting the cached loads, this is the full check
+		vector<int> loads = calculateSprintLoads();
+
+#ifdef LNS_AVX2_KERNELS
+		if (useAvx2Kernels)
+			return withinCapacitiesKernelAvx2(loads.data(), instance->sprintCapacities.data(), loads.size());
+#endif
+
+		return withinCapacitiesKernel(loads.data(), instance->sprintCapacities.data(), loads.size());
+	}
+
+	bool storyDependenciesSatisfied() {
+		const ProblemInstance &problem = *instance;
+
+		for (int storyNumber = 0; storyNumber < assignedSprints.size(); ++storyNumber) {
+			int assignedSprint = assignedSprints[storyNumber];
+
+			// Don't check stories that are unassigned or assigned to the product backlog
+			if (assignedSprint == -1 || assignedSprint == problem.backlogSprint)
+				continue;
+
+			for (int dependencyNumber : problem.dependencies(storyNumber)) {
+				int dependencySprint = assignedSprints[dependencyNumber];
+
+				// The dependency isn't assigned to a sprint, or is assigned to the special product backlog
+				if (dependencySprint == -1 || dependencySprint == problem.backlogSprint)
+					return false;
+
+				// The story is assigned to an earlier sprint than its dependency
+				if (problem.sprintNumbers[assignedSprint] <= problem.sprintNumbers[dependencySprint])
+					return false;
+			}
+		}
+
+		// All stories have their dependencies assigned to an earlier sprint
+		return true;
+	}
+
+	// Checks feasibility from scratch, rather than trusting the counts of violations
+	bool verifyFeasibility() {
+		return sprintCapacitiesSatisifed() && storyDependenciesSatisfied();
+	}
+
+	bool isFeasible() {
+		STATS_TIMER(TIMER_FEASIBILITY);
+
+		bool feasible = overloadedSprints == 0 && precedenceViolations == 0;
+
+		// Debug builds double-check the counts of violations against the full checker
+		assert(feasible == verifyFeasibility());
+		assert(sprintLoads == calculateSprintLoads());
+
+#ifdef LNS_VERIFY
+		if (verifySample() && feasible != shadow.isFeasible())
+			verificationFailed("feasibility");
+#endif
+
+		return feasible;
+	}
+
+	// Memory used by the solution itself (not counting the shared instance), in bytes
+	size_t memoryUsage() const {
+		return sizeof(Roadmap) + assignedSprints.memoryUsage() + sizeof(int) * sprintLoads.capacity();
+	}
+
+	string printStoryRoadmap() {
+		string outputString = "";
+
+		for (int storyNumber = 0; storyNumber < assignedSprints.size(); ++storyNumber) {
+			if (isAssigned(storyNumber))
+				outputString += instance->story(storyNumber).toString() + "\n  >> " + instance->sprints[assignedSprints[storyNumber]].toString() + "\n";
+		}
+
+		return outputString;
+	}
+
+	// Machine-readable list of which sprint each story is assigned to (-1 being the product backlog)
+	string printAssignments() {
+		string outputString = "story_number,sprint_number\n";
+
+		for (int storyNumber = 0; storyNumber < assignedSprints.size(); ++storyNumber) {
+			if (isAssigned(storyNumber))
+				outputString += to_string(instance->graph->storyIds[storyNumber]) + "," + to_string(instance->sprintNumbers[assignedSprints[storyNumber]]) + "\n";
+		}
+
+		return outputString;
+	}
+
+	// Writes a (story ID, old sprint number, new sprint number) line for each story whose sprint differs from the previous assignments
+	// (as read by loadAssignments), as it goes rather than building the output up first. Stories that are new or no longer exist
+	// have no old or new sprint number. Returns the number of lines written
+	int writeChangedAssignments(ostream &output, const map<int, int> &previousAssignments) {
+		int changes = 0;
+
+		output << "story_number,old_sprint_number,new_sprint_number\n";
+
+		for (int storyNumber = 0; storyNumber < assignedSprints.size(); ++storyNumber) {
+			int storyId = instance->graph->storyIds[storyNumber];
+			auto previousAssignment = previousAssignments.find(storyId);
+			int sprintNumber = isAssigned(storyNumber) ? instance->sprintNumbers[assignedSprints[storyNumber]] : -1;
+
+			if (previousAssignment == previousAssignments.end()) {
+				output << storyId << ",," << sprintNumber << '\n';
+				++changes;
+			}
+			else if (previousAssignment->second != sprintNumber) {
+				output << storyId << ',' << previousAssignment->second << ',' << sprintNumber << '\n';
+				++changes;
+			}
+		}
+
+		for (pair<const int, int> previousAssignment : previousAssignments) {
+			if (instance->storyNumberOf(previousAssignment.first) == -1) {
+				output << previousAssignment.first << ',' << previousAssignment.second << ",\n";
+				++changes;
+			}
+		}
+
+		return changes;
+	}
+
+	string printSprintRoadmap() {
+		string outputString = "";
+
+		for (int sprint = 0; sprint < numberOfSprints(); ++sprint) {
+			vector<int> sprintStories = storiesInSprint(sprint);
+
+			if (!sprintStories.empty()) {
+				Sprint sprintData = instance->sprints[sprint];
+
+				if (sprint == instance->backlogSprint)
+					outputString += "Product Backlog";
+				else
+					outputString += sprintData.toString();
+
+				int valueDelivered = 0;
+				int storyPointsAssigned = 0;
+
+				for (int storyNumber : sprintStories) {
+					valueDelivered += instance->storyValues[storyNumber];
+					storyPointsAssigned += instance->graph->storyPoints[storyNumber];
+
+					outputString += "\n\t" + instance->story(storyNumber).toString();
+				}
+
+				outputString += "\n-- [Value: " + to_string(valueDelivered)
+					+ " (weighted value: " + to_string(valueDelivered * sprintData.sprintBonus) + "), "
+					+ "story points: " + to_string(storyPointsAssigned) + "]";
+
+				outputString += "\n\n";
+			}
+		}
+
+		return outputString;
+	}
+};
+
+// Returns a random position in the input vector according to the given probability distribution of getting each position
+int randomIntDiscreteDistribution(vector<double> probabilities) {
+	// Randomly generated percentage
+	double randomPercentage = (double)(nextRandom() % 1024) / 1024;
+
+	// Threshold representing the upper limit of each probability band
+	double threshold = probabilities[0];
+
+	for (int i = 0; i < probabilities.size(); ++i) {
+		// If the random percentage is within this vector position's probability threshold, return the position
+		if (randomPercentage < threshold)
+			return i;
+		else
+			// If not, extend the threshold to the next probability band
+			threshold += probabilities[i + 1];
+	}
+}
+
+// Uses the parametric equation of a geometric sequence to return a vector of doubles
+vector<double> geometricSequence(double a, double r, double n) {
+	vector<double> sequence;
+
+	for (int i = 0; i < n; ++i) {
+		sequence.push_back(a * pow(r, i));
+	}
+
+	return sequence;
+}
+
+// Bump allocator for the scratch data of an LNS iteration (removed stories, moves, sampling pools, BFS queues)
+// It is reset at the start of every iteration, so once it has grown big enough the search loop never touches the heap.
+// Every allocation it has to make from the heap is counted, so that can be checked
+class ScratchArena {
+public:
+	char *block;
+	size_t blockSize;
+	size_t used;
+
+	// Blocks taken from the heap when the main block ran out of room, replaced by one bigger main block on the next reset
+	vector<char *> overflowBlocks;
+	size_t overflowSize;
+
+	// Number of times the arena has had to allocate from the heap
+	long long heapAllocations;
+
+	ScratchArena() {
+		this->block = NULL;
+		this->blockSize = 0;
+		this->used = 0;
+		this->overflowSize = 0;
+		this->heapAllocations = 0;
+	}
+
+	ScratchArena(const ScratchArena&) = delete;
+	ScratchArena& operator = (const ScratchArena&) = delete;
+
+	~ScratchArena() {
+		for (char *overflowBlock : overflowBlocks)
+			delete[] overflowBlock;
+
+		delete[] block;
+	}
+
+	void *allocate(size_t size, size_t alignment) {
+		size_t start = (used + alignment - 1) / alignment * alignment;
+
+		if (start + size <= blockSize) {
+			used = start + size;
+			return block + start;
+		}
+
+		// Out of room, fall back to the heap until the next reset
+		char *overflowBlock = new char[size];
+		overflowBlocks.push_back(overflowBlock);
+		overflowSize += size;
+		++heapAllocations;
+
+		return overflowBlock;
+	}
+
+	// Frees everything allocated since the last reset
+	void reset() {
+		if (!overflowBlocks.empty()) {
+			// Grow the main block so that it fits everything the last iteration needed
+			size_t newBlockSize = max(2 * blockSize, used + overflowSize + 64 * overflowBlocks.size());
+
+			for (char *overflowBlock : overflowBlocks)
+				delete[] overflowBlock;
+
+			overflowBlocks.clear();
+			overflowSize = 0;
+
+			delete[] block;
+			block = new char[newBlockSize];
+			blockSize = newBlockSize;
+			++heapAllocations;
+		}
+
+		used = 0;
+	}
+};
+
+// Standard library allocator handing out memory from a scratch arena (or from the heap if it doesn't have one)
+template <typename T>
+class ArenaAllocator {
+public:
+	typedef T value_type;
+
+	ScratchArena *arena;
+
+	ArenaAllocator() {
+		this->arena = NULL;
+	}
+
+	ArenaAllocator(ScratchArena *arena) {
+		this->arena = arena;
+	}
+
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U>& other) {
+		this->arena = other.arena;
+	}
+
+	T *allocate(size_t n) {
+		if (arena == NULL)
+			return (T *)::operator new(n * sizeof(T));
+
+		return (T *)arena->allocate(n * sizeof(T), alignof(T));
+	}
+
+	void deallocate(T *pointer, size_t) {
+		// Arena memory is all freed at once when the arena is reset
+		if (arena == NULL)
+			::operator delete(pointer);
+	}
+
+	template <typename U>
+	bool operator == (const ArenaAllocator<U>& other) const {
+		return this->arena == other.arena;
+	}
+
+	template <typename U>
+	bool operator != (const ArenaAllocator<U>& other) const {
+		return this->arena != other.arena;
+	}
+};
+
+// A vector whose elements live in a scratch arena
+template <typename T>
+using ScratchVector = vector<T, ArenaAllocator<T>>;
+
+// Represents moving a story from/to a sprint
+class Move {
+public:
+	int storyNumber;
+	int sprint; // Position of the sprint in the roadmap's list of sprints
+
+	Move() {};
+
+	Move(int storyNumber, int sprint) {
+		this->storyNumber = storyNumber;
+		this->sprint = sprint;
+	}
+
+	bool operator == (const Move& other) const {
+		return this->storyNumber == other.storyNumber && this->sprint == other.sprint;
+	}
+
+	bool operator < (const Move& other) const {
+		if (this->storyNumber < other.storyNumber)
+			return true;
+		else if (this->storyNumber == other.storyNumber && this->sprint < other.sprint)
+			return true;
+		else
+			return false;
+	}
+};
+
+// A partly-destroyed solution, a list of the stories that were removed, and the moves that removed them
+class DestroyedRoadmap {
+public:
+	Roadmap roadmap;
+	ScratchVector<int> removedStories;
+	ScratchVector<Move> moves;
+
+	DestroyedRoadmap() {};
+
+	// Starts new, empty lists in the arena (which is expected to have just been reset)
+	void resetScratch(ScratchArena *arena, int numberOfStoriesToRemove) {
+		removedStories = ScratchVector<int>(ArenaAllocator<int>(arena));
+		removedStories.reserve(numberOfStoriesToRemove);
+
+		moves = ScratchVector<Move>(ArenaAllocator<Move>(arena));
+		moves.reserve(numberOfStoriesToRemove);
+	}
+};
+
+// A repaired solution and the list of moves that repaired it
+class RepairedRoadmap {
+public:
+	Roadmap roadmap;
+	ScratchVector<Move> moves;
+
+	RepairedRoadmap() {};
+
+	RepairedRoadmap(Roadmap roadmap, ScratchVector<Move> moves) {
+		this->roadmap = roadmap;
+		this->moves = moves;
+	}
+
+	// Starts a new, empty list of moves in the arena (which is expected to have just been reset)
+	void resetScratch(ScratchArena *arena, int numberOfStoriesToInsert) {
+		moves = ScratchVector<Move>(ArenaAllocator<Move>(arena));
+		moves.reserve(numberOfStoriesToInsert);
+	}
+};
+
+// A Tabu list holding the banned moves
+class TabuList {
+public:
+	// The iteration at which each move became tabu, as a flat (story number x sprint position) matrix
+	vector<int> tabuIterations;
+	int numberOfSprints;
+	int tenure;
+
+	// In compact mode only the latest tabu move of each story is remembered, which needs one entry per story
+	// rather than one per story and sprint
+	bool compact;
+	vector<SprintPosition> tabuSprints;
+
+	TabuList() {
+		this->numberOfSprints = 0;
+		this->tenure = 0;
+		this->compact = false;
+	}
+
+	TabuList(int numberOfStories, int numberOfSprints, int tenure, bool compact = false) {
+		reset(numberOfStories, numberOfSprints, tenure, compact);
+	}
+
+	// Empties the list for a problem of the given size, reusing the matrix's memory where it's big enough
+	void reset(int numberOfStories, int numberOfSprints, int tenure, bool compact = false) {
+		this->numberOfSprints = numberOfSprints;
+		this->tenure = tenure;
+		this->compact = compact;
+
+		if (compact) {
+			tabuIterations.assign(numberOfStories, INT_MIN);
+			tabuSprints.assign(numberOfStories, -1);
+		}
+		else {
+			tabuIterations.assign((size_t)numberOfStories * numberOfSprints, INT_MIN);
+			tabuSprints.clear();
+		}
+	}
+
+	void add(Move move, int currentIteration) {
+		// Store the iteration when the move became tabu
+		if (compact) {
+			tabuIterations[move.storyNumber] = currentIteration;
+			tabuSprints[move.storyNumber] = move.sprint;
+		}
+		else {
+			tabuIterations[(size_t)move.storyNumber * numberOfSprints + move.sprint] = currentIteration;
+		}
+	}
+
+	bool isTabu(Move move, int currentIteration) {
+		if (compact && tabuSprints[move.storyNumber] != move.sprint)
+			return false;
+
+		int tabuIteration = compact ? tabuIterations[move.storyNumber] : tabuIterations[(size_t)move.storyNumber * numberOfSprints + move.sprint];
+
+		// The move was never made tabu
+		if (tabuIteration == INT_MIN)
+			return false;
+
+		// The move is tabu until its tenure is over
+		return currentIteration - tenure <= tabuIteration;
+	}
+};
+
+// The user-settable parameters of a run of the LNS
+class LNSParameters {
+public:
+	// Stop as soon as the best solution is within this fraction of the upper bound (0 only stops at the bound itself)
+	double optimalityGap;
+
+	// Fraction of the default iteration budget (and initial temperature calibration trials) to spend
+	double iterationBudget;
+
+	// Trades a little search accuracy for memory on very large problems (see TabuList)
+	bool compactMode;
+
+	// Names of the policies the search is built from (see LNSEngine): how stories are removed (alternating, radial or random),
+	// how they're put back (knapsack, or greedy into the earliest sprint they fit), whether a worse solution can be accepted
+	// (annealing or improving) and how the temperature falls (geometric or linear)
+	string ruinPolicy, repairPolicy, acceptancePolicy, coolingPolicy;
+
+	// Number of ruin and repair candidates built in parallel from the current solution at each iteration
+	int candidatesPerIteration;
+
+	// Polish the best solution with shift and swap moves once the search is over (see LNS::localSearch)
+	bool useLocalSearch;
+
+	// Where to save the state of the search every checkpointInterval seconds (no checkpoints if empty),
+	// and whether to carry on from the checkpoint there if there is one
+	string checkpointFileName;
+	double checkpointInterval;
+	bool resume;
+
+	// Stories the ruin operators start removing from, to focus the search on part of the roadmap (every story if not set)
+	shared_ptr<const vector<int>> ruinCandidates;
+
+	// Initial temperature of the annealing, calibrated from random roadmaps if not positive
+	double startTemperature;
+
+	// Upper bound on the value of any roadmap of the problem (see LNS::calculateUpperBound), worked out by the search if negative,
+	// so that callers running many searches of the same problem only work it out once
+	int upperBound;
+
+	// Number of iterations to search for, or 0 for twice the problem size scaled by the iteration budget
+	int maxIterations;
+
+	// Fraction of the temperature kept from one iteration to the next by geometric cooling
+	double coolingRate;
+
+	// Fraction of the stories (or ruin candidates) removed by each ruin
+	double degreeOfDestruction;
+
+	// Number of iterations a move stays tabu, as a fraction of the problem size (stories x sprints)
+	double tabuTenureFraction;
+
+	// Fraction of the iterations the search can go without a new best solution before it restarts (0.1 allows 10 restarts)
+	double maxNonImprovingFraction;
+
+	// Seconds to search for at most, whatever's left of the iterations (no limit if not positive)
+	double timeLimit;
+
+	// Number of good, diverse roadmaps kept to restart from when the search stops improving (restarts are from random roadmaps if 0)
+	int elitePoolSize;
+
+	// Carry on the search left in the workspace by the last run for another maxIterations, rather than starting a new one
+	// (see LNS::runParallelTempering, which runs each replica a few iterations at a time)
+	bool continueSearch;
+
+	LNSParameters() {
+		this->optimalityGap = 0.0;
+		this->iterationBudget = 1.0;
+		this->compactMode = false;
+		this->candidatesPerIteration = 1;
+		this->ruinPolicy = "alternating";
+		this->repairPolicy = "knapsack";
+		this->acceptancePolicy = "annealing";
+		this->coolingPolicy = "geometric";
+		this->useLocalSearch = true;
+		this->checkpointInterval = 60.0;
+		this->resume = false;
+		this->startTemperature = 0.0;
+		this->upperBound = -1;
+		this->maxIterations = 0;
+		this->coolingRate = 0.9;
+		this->degreeOfDestruction = 0.15;
+		this->tabuTenureFraction = 0.1;
+		this->maxNonImprovingFraction = 0.1;
+		this->timeLimit = 0.0;
+		this->continueSearch = false;
+		this->elitePoolSize = 10;
+	}
+
+	// Sets a parameter by its name in config files (see loadConfig and toConfig)
+	void set(const string &name, const string &value) {
+		if (name == "gap")
+			optimalityGap = stod(value);
+		else if (name == "budget")
+			iterationBudget = stod(value);
+		else if (name == "time_limit")
+			timeLimit = stod(value);
+		else if (name == "cooling_rate")
+			coolingRate = stod(value);
+		else if (name == "destruction")
+			degreeOfDestruction = stod(value);
+		else if (name == "tabu_tenure")
+			tabuTenureFraction = stod(value);
+		else if (name == "non_improving")
+			maxNonImprovingFraction = stod(value);
+		else if (name == "candidates")
+			candidatesPerIteration = max(1, stoi(value));
+		else if (name == "elite_pool")
+			elitePoolSize = max(0, stoi(value));
+		else if (name == "ruin")
+			ruinPolicy = value;
+		else if (name == "repair")
+			repairPolicy = value;
+		else if (name == "accept")
+			acceptancePolicy = value;
+		else if (name == "cooling")
+			coolingPolicy = value;
+		else
+			throw runtime_error("Unknown parameter " + name);
+	}
+
+	// Throws if a setting is out of the range the search can work with, whether it came from the command line, a config file or a request
+	// (written so that NaN fails every check)
+	void validate() const {
+		auto outOfRange = [](const string &name, const string &option, double value, const string &range) {
+			ostringstream message;
+			message << name << " (" << option << ") must be " << range << ", not " << value;
+			return runtime_error(message.str());
+		};
+
+		if (!(optimalityGap >= 0.0 && optimalityGap < 1.0))
+			throw outOfRange("gap", "--gap", optimalityGap, "at least 0 and below 1");
+
+		if (!(iterationBudget > 0.0))
+			throw outOfRange("budget", "--budget", iterationBudget, "above 0");
+
+		if (!(timeLimit >= 0.0))
+			throw outOfRange("time_limit", "--time-limit", timeLimit, "at least 0 (0 for no limit)");
+
+		if (!(coolingRate > 0.0 && coolingRate < 1.0))
+			throw outOfRange("cooling_rate", "--cooling-rate", coolingRate, "above 0 and below 1");
+
+		if (!(degreeOfDestruction > 0.0 && degreeOfDestruction <= 1.0))
+			throw outOfRange("destruction", "--destruction", degreeOfDestruction, "above 0 and at most 1");
+
+		if (!(tabuTenureFraction >= 0.0 && tabuTenureFraction <= 1.0))
+			throw outOfRange("tabu_tenure", "--tabu-tenure", tabuTenureFraction, "at least 0 and at most 1");
+
+		if (!(maxNonImprovingFraction >= 0.0))
+			throw outOfRange("non_improving", "--non-improving", maxNonImprovingFraction, "at least 0 (above 1 never restarts)");
+
+		if (!(checkpointInterval > 0.0))
+			throw outOfRange("checkpoint interval", "--checkpoint-interval", checkpointInterval, "above 0");
+	}
+
+	// The search settings as (parameter, value) rows, starting with a header row, that set() reads back in
+	string toConfig() const {
+		ostringstream config;
+		config.precision(10);
+
+		config << "parameter,value\n"
+			<< "gap," << optimalityGap << "\n"
+			<< "budget," << iterationBudget << "\n"
+			<< "time_limit," << timeLimit << "\n"
+			<< "cooling_rate," << coolingRate << "\n"
+			<< "destruction," << degreeOfDestruction << "\n"
+			<< "tabu_tenure," << tabuTenureFraction << "\n"
+			<< "non_improving," << maxNonImprovingFraction << "\n"
+			<< "candidates," << candidatesPerIteration << "\n"
+			<< "elite_pool," << elitePoolSize << "\n"
+			<< "ruin," << ruinPolicy << "\n"
+			<< "repair," << repairPolicy << "\n"
+			<< "accept," << acceptancePolicy << "\n"
+			<< "cooling," << coolingPolicy << "\n";
+
+		return config.str();
+	}
+
+	// Name of the combination of policies in the registry of prebuilt engines (see lnsEngines)
+	string engineName() const {
+		return ruinPolicy + "/" + repairPolicy + "/" + acceptancePolicy + "/" + coolingPolicy;
+	}
+};
+
+// A ruin and repair proposal, built in its own buffers so that several can be built at once
+class Candidate {
+public:
+	DestroyedRoadmap destroyedSolution;
+	RepairedRoadmap repairedSolution;
+	int repairedSolutionValue;
+
+	// Holds the scratch data of the candidate's current iteration
+	ScratchArena arena;
+
+	// Number of assignment chunks building the candidate has had to take from the heap rather than its problem's ChunkPool
+	long long chunkHeapAllocations;
+
+	Candidate() {
+		this->repairedSolutionValue = 0;
+		this->chunkHeapAllocations = 0;
+	}
+};
+
+// A fixed set of helper threads that run the same task in lockstep with the calling thread
+// Task 0 runs on the calling thread and task i on helper i, so n - 1 helpers give n parallel tasks
+class ParallelTasks {
+public:
+	vector<thread> helpers;
+	mutex tasksMutex;
+	condition_variable tasksStarted;
+	condition_variable tasksFinished;
+
+	const function<void(int)> *task;
+	long long generation; // Counts the rounds of tasks so that helpers can tell a new round from the last one
+	int unfinishedTasks;
+	bool stopping;
+
+	ParallelTasks() {
+		this->task = NULL;
+		this->generation = 0;
+		this->unfinishedTasks = 0;
+		this->stopping = false;
+	}
+
+	ParallelTasks(const ParallelTasks&) = delete;
+	ParallelTasks& operator = (const ParallelTasks&) = delete;
+
+	~ParallelTasks() {
+		stop();
+	}
+
+	int size() {
+		return helpers.size() + 1;
+	}
+
+	// Replaces the helpers with enough to run the given number of tasks at once
+	// Each helper gets its own random number generator, seeded from the calling thread's
+	void resize(int numberOfTasks) {
+		stop();
+
+		stopping = false;
+		generation = 0;
+
+		for (int index = 1; index < numberOfTasks; ++index) {
+			unsigned long long seed = ((unsigned long long)nextRandom() << 32) | nextRandom();
+
+			helpers.push_back(thread([this, index, seed]() {
+				seedRandom(seed);
+				work(index);
+			}));
+		}
+	}
+
+	void stop() {
+		{
+			lock_guard<mutex> lock(tasksMutex);
+			stopping = true;
+		}
+
+		tasksStarted.notify_all();
+
+		for (thread &helper : helpers)
+			helper.join();
+
+		helpers.clear();
+	}
+
+	// Runs task(0) to task(size() - 1) in parallel and returns when they have all finished
+	void run(const function<void(int)> &task) {
+		{
+			lock_guard<mutex> lock(tasksMutex);
+			this->task = &task;
+			unfinishedTasks = helpers.size();
+			++generation;
+		}
+
+		tasksStarted.notify_all();
+
+		task(0);
+
+		unique_lock<mutex> lock(tasksMutex);
+		tasksFinished.wait(lock, [this]() { return unfinishedTasks == 0; });
+	}
+
+	void work(int index) {
+		long long lastGeneration = 0;
+
+		while (true) {
+			const function<void(int)> *currentTask;
+
+			{
+				unique_lock<mutex> lock(tasksMutex);
+				tasksStarted.wait(lock, [this, lastGeneration]() { return stopping || generation != lastGeneration; });
+
+				if (stopping)
+					return;
+
+				lastGeneration = generation;
+				currentTask = task;
+			}
+
+			(*currentTask)(index);
+
+			{
+				lock_guard<mutex> lock(tasksMutex);
+				--unfinishedTasks;
+			}
+
+			tasksFinished.notify_one();
+		}
+	}
+};
+
+// The state of a run of the LNS at the start of an iteration, which is everything needed to carry on exactly where it left off
+// Saved as a binary file in the machine's own byte order (checkpoints are for resuming on the same kind of machine, not for exchange)
+class Checkpoint {
+public:
+	unsigned long long instanceFingerprint;
+	int numberOfStories, numberOfSprints;
+
+	int currentIteration, nonImprovingIterations, ruinMode;
+	double temperature, startTemperature;
+	unsigned long long randomState;
+
+	vector<SprintPosition> currentAssignments, bestAssignments;
+
+	bool compactTabuList;
+	vector<int> tabuIterations;
+	vector<SprintPosition> tabuSprints;
+
+	// The elite pool: the elites' assignments one after the other, and their values
+	vector<SprintPosition> eliteAssignments;
+	vector<int> eliteValues;
+
+	// Seconds the search had been running for, which count towards the time limit of the resumed search
+	double elapsedTime;
+
+	Checkpoint() {
+		this->instanceFingerprint = 0;
+		this->numberOfStories = 0;
+		this->numberOfSprints = 0;
+		this->currentIteration = 0;
+		this->nonImprovingIterations = 0;
+		this->ruinMode = 0;
+		this->temperature = 0;
+		this->startTemperature = 0;
+		this->randomState = 0;
+		this->compactTabuList = false;
+		this->elapsedTime = 0;
+	}
+
+	// Replaces the file with this checkpoint
+	// The checkpoint is written to a temporary file which is then renamed over the old one, so being killed part way through
+	// leaves the previous checkpoint intact rather than a half-written one
+	void save(string fileName) {
+		string temporaryFileName = fileName + ".tmp";
+		FILE *file = fopen(temporaryFileName.c_str(), "wb");
+
+		if (file == NULL)
+			throw runtime_error("Cannot open checkpoint file " + temporaryFileName);
+
+		bool written = fwrite(magic, 1, sizeof(magic), file) == sizeof(magic)
+			&& writeValue(file, instanceFingerprint) && writeValue(file, numberOfStories) && writeValue(file, numberOfSprints)
+			&& writeValue(file, currentIteration) && writeValue(file, nonImprovingIterations) && writeValue(file, ruinMode)
+			&& writeValue(file, temperature) && writeValue(file, startTemperature) && writeValue(file, randomState)
+			&& writeVector(file, currentAssignments) && writeVector(file, bestAssignments)
+			&& writeValue(file, compactTabuList) && writeVector(file, tabuIterations) && writeVector(file, tabuSprints)
+			&& writeVector(file, eliteAssignments) && writeVector(file, eliteValues) && writeValue(file, elapsedTime)
+			&& fflush(file) == 0;
+
+#ifndef _WIN32
+		// Make sure the data is on disk before the rename can be, in case the whole machine goes down
+		written = written && fsync(fileno(file)) == 0;
+#endif
+
+		written = fclose(file) == 0 && written;
+
+		if (!written)
+			throw runtime_error("Cannot write checkpoint file " + temporaryFileName);
+
+#ifdef _WIN32
+		bool renamed = MoveFileExA(temporaryFileName.c_str(), fileName.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+		bool renamed = rename(temporaryFileName.c_str(), fileName.c_str()) == 0;
+#endif
+
+		if (!renamed)
+			throw runtime_error("Cannot replace checkpoint file " + fileName);
+	}
+
+	// Returns false if there's no checkpoint file to load
+	bool load(string fileName) {
+		FILE *file = fopen(fileName.c_str(), "rb");
+
+		if (file == NULL)
+			return false;
+
+		char fileMagic[sizeof(magic)];
+
+		bool read = fread(fileMagic, 1, sizeof(fileMagic), file) == sizeof(fileMagic) && memcmp(fileMagic, magic, sizeof(magic)) == 0
+			&& readValue(file, instanceFingerprint) && readValue(file, numberOfStories) && readValue(file, numberOfSprints)
+			&& readValue(file, currentIteration) && readValue(file, nonImprovingIterations) && readValue(file, ruinMode)
+			&& readValue(file, temperature) && readValue(file, startTemperature) && readValue(file, randomState)
+			&& readVector(file, currentAssignments) && readVector(file, bestAssignments)
+			&& readValue(file, compactTabuList) && readVector(file, tabuIterations) && readVector(file, tabuSprints)
+			&& readVector(file, eliteAssignments) && readVector(file, eliteValues) && readValue(file, elapsedTime)
+			&& eliteAssignments.size() == eliteValues.size() * numberOfStories;
+
+		fclose(file);
+
+		if (!read)
+			throw runtime_error("Checkpoint file " + fileName + " is corrupt or from another version");
+
+		return true;
+	}
+
+	// Rebuilds one of the saved solutions (recounting its sprint loads and violations as it goes)
+	static Roadmap restoreRoadmap(shared_ptr<const ProblemInstance> instance, const vector<SprintPosition> &assignments) {
+		Roadmap roadmap(instance);
+
+		for (int storyNumber = 0; storyNumber < assignments.size(); ++storyNumber) {
+			if (assignments[storyNumber] != -1)
+				roadmap.addStoryToSprint(storyNumber, assignments[storyNumber]);
+		}
+
+		return roadmap;
+	}
+
+private:
+	static constexpr char magic[8] = { 'A', 'L', 'S', 'C', 'K', 'P', 'T', '3' };
+
+	template <typename T>
+	static bool writeValue(FILE *file, const T &value) {
+		return fwrite(&value, sizeof(T), 1, file) == 1;
+	}
+
+	template <typename T>
+	static bool writeVector(FILE *file, const vector<T> &values) {
+		unsigned long long size = values.size();
+		return writeValue(file, size) && fwrite(values.data(), sizeof(T), values.size(), file) == values.size();
+	}
+
+	template <typename T>
+	static bool readValue(FILE *file, T &value) {
+		return fread(&value, sizeof(T), 1, file) == 1;
+	}
+
+	template <typename T>
+	static bool readVector(FILE *file, vector<T> &values) {
+		unsigned long long size;
+
+		// Refuse sizes that can't be right before trying to allocate them
+		if (!readValue(file, size) || size > (1ULL << 40) / sizeof(T))
+			return false;
+
+		values.resize(size);
+		return fread(values.data(), sizeof(T), size, file) == size;
+	}
+};
+
+constexpr char Checkpoint::magic[8];
+
+// The solutions and tabu list used by a run of the LNS
+// A long-running worker keeps one between runs so that it reuses their allocations rather than starting from scratch
+class LNSWorkspace {
+public:
+	Roadmap currentSolution;
+	Roadmap bestSolution;
+	TabuList tabuList;
+
+	// Iterations the search in the workspace has done, for continuing it (see LNSParameters::continueSearch)
+	int iterations;
+
+	// The candidates built at each iteration, and the helper threads that build all but the first
+	vector<unique_ptr<Candidate>> candidates;
+	ParallelTasks candidateTasks;
+
+	LNSWorkspace() {
+		this->iterations = 0;
+	};
+
+	// Makes sure there are buffers (and threads) for the given number of candidates per iteration
+	void reserveCandidates(int numberOfCandidates) {
+		while (candidates.size() < numberOfCandidates)
+			candidates.push_back(unique_ptr<Candidate>(new Candidate()));
+
+		candidates.resize(numberOfCandidates);
+
+		if (candidateTasks.size() != numberOfCandidates)
+			candidateTasks.resize(numberOfCandidates);
+	}
+};
+
+// Good roadmaps found by a search, kept for it to restart from. They're kept different from each other, so that restarts don't all lead
+// back to the same solution
+class ElitePool {
+public:
+	int capacity;
+	vector<Roadmap> roadmaps;
+	vector<int> values;
+
+	// Number of stories a roadmap must differ from every elite by to join the pool alongside them
+	int minimumDistance;
+
+	ElitePool(int capacity, int minimumDistance) {
+		this->capacity = capacity;
+		this->minimumDistance = max(1, minimumDistance);
+	}
+
+	int size() const {
+		return roadmaps.size();
+	}
+
+	// Number of stories the roadmaps assign to different sprints (chunks the roadmaps still share are the same by definition)
+	static int distance(const Roadmap &a, const Roadmap &b) {
+		int differences = 0;
+
+		for (int chunk = 0; chunk < a.assignedSprints.numberOfChunks(); ++chunk) {
+			const SprintPosition *aSprints = a.assignedSprints.chunkData(chunk);
+			const SprintPosition *bSprints = b.assignedSprints.chunkData(chunk);
+
+			if (aSprints == bSprints)
+				continue;
+
+			for (int i = 0; i < a.assignedSprints.chunkLength(chunk); ++i)
+				differences += aSprints[i] != bSprints[i];
+		}
+
+		return differences;
+	}
+
+	// Adds the roadmap to the pool if it's far enough from every elite, and otherwise only in place of the close elite if it's better.
+	// Once the pool is full, it replaces the elite most like it of those it's better than, or isn't added if it's no better than any
+	// of them. Returns whether it was added
+	bool offer(const Roadmap &roadmap, int value) {
+		if (capacity <= 0)
+			return false;
+
+		int mostSimilar = -1;
+		int smallestDistance = INT_MAX;
+
+		for (int i = 0; i < roadmaps.size(); ++i) {
+			int elitesDistance = distance(roadmap, roadmaps[i]);
+
+			if (elitesDistance < minimumDistance) {
+				if (values[i] >= value)
+					return false;
+
+				roadmaps[i] = roadmap;
+				values[i] = value;
+				return true;
+			}
+
+			if (values[i] < value && elitesDistance < smallestDistance) {
+				mostSimilar = i;
+				smallestDistance = elitesDistance;
+			}
+		}
+
+		if (roadmaps.size() < capacity) {
+			roadmaps.push_back(roadmap);
+			values.push_back(value);
+			return true;
+		}
+
+		if (mostSimilar == -1)
+			return false;
+
+		roadmaps[mostSimilar] = roadmap;
+		values[mostSimilar] = value;
+		return true;
+	}
+};
+
+// One level of a multilevel solve: a smaller problem whose stories (super-stories) each stand for a group of stories of the level below
+class CoarseLevel {
+public:
+	shared_ptr<const ProblemInstance> instance;
+
+	// The super-story that each story of the level below belongs to
+	vector<int> superStories;
+};
+
+// Implements the Large Neighbourhood search algorithm
+class LNS {
+public:
+	LNS() {};
+
+	/*
+	// Adapted from:
+	// GeeksforGeeks. (2018). Breadth First Search or BFS for a Graph - GeeksforGeeks. [online] Available at: https://www.geeksforgeeks.org/breadth-first-search-or-bfs-for-a-graph/ [Accessed 9 Dec. 2018].
+	*/
+	// Removes stories from the destroyed roadmap by traversing the dependency graph in breadth-first order
+	// (visitStamps marks the stories this traversal has visited with its own stamp, so it needn't be cleared between traversals,
+	// and queue is used as a FIFO queue, which never needs more room than there are stories as none are queued twice)
+	static void traverseDependenciesBF(int storyNumber, DestroyedRoadmap &destroyedSolution, int numberOfStoriesToRemove, ScratchVector<int> &visitStamps, int stamp, ScratchVector<int> &queue) {
+		Roadmap &roadmap = destroyedSolution.roadmap;
+
+		queue.clear();
+		int queueFront = 0;
+
+		visitStamps[storyNumber] = stamp;
+		queue.push_back(storyNumber);
+
+		while (queueFront < queue.size() && destroyedSolution.removedStories.size() < numberOfStoriesToRemove) {
+			storyNumber = queue[queueFront++];
+
+			// Only remove the story if it's not already been removed
+			if (roadmap.isAssigned(storyNumber)) {
+				// Add to the list of moves (which will be checked against the tabu list later)
+				destroyedSolution.moves.push_back(Move(storyNumber, roadmap.assignedSprints[storyNumber]));
+				destroyedSolution.removedStories.push_back(storyNumber);
+
+				roadmap.removeStoryFromSprint(storyNumber);
+			}
+
+			for (int dependeeNumber : roadmap.instance->dependencies(storyNumber)) {
+				if (visitStamps[dependeeNumber] != stamp) {
+					visitStamps[dependeeNumber] = stamp;
+					queue.push_back(dependeeNumber);
+				}
+			}
+		}
+	}
+
+	// Fills the list with the stories that a ruin can start from: the given candidates, or else every story
+	static void ruinStartingStories(const vector<int> *ruinCandidates, int numberOfStories, ScratchVector<int> &stories) {
+		if (ruinCandidates != NULL) {
+			stories.assign(ruinCandidates->begin(), ruinCandidates->end());
+			return;
+		}
+
+		stories.resize(numberOfStories);
+
+		for (int i = 0; i < numberOfStories; ++i)
+			stories[i] = i;
+	}
+
+	// Removes the given number of stories and its dependencies
+	static void radialRuin(const Roadmap &completeSolution, int numberOfStoriesToRemove, const vector<int> *ruinCandidates, DestroyedRoadmap &destroyedSolution, ScratchArena &arena) {
+		STATS_TIMER(TIMER_RADIAL_RUIN);
+
+		destroyedSolution.roadmap = completeSolution;
+		destroyedSolution.resetScratch(&arena, numberOfStoriesToRemove);
+
+		int numberOfStories = completeSolution.numberOfStories();
+
+		ArenaAllocator<int> allocator(&arena);
+
+		// Used to randomly select stories without replacement
+		ScratchVector<int> stories(allocator);
+		ruinStartingStories(ruinCandidates, numberOfStories, stories);
+
+		ScratchVector<int> visitStamps(numberOfStories, 0, ArenaAllocator<int>(&arena));
+		int traversals = 0;
+
+		ScratchVector<int> queue(allocator);
+		queue.reserve(numberOfStories);
+
+		while (destroyedSolution.removedStories.size() < numberOfStoriesToRemove) {
+			int randomPosition = randomInt(0, stories.size() - 1);
+			int randomStory = stories[randomPosition];
+
+			// Remove the story from the list of unremoved stories
+			stories[randomPosition] = stories.back();
+			stories.pop_back();
+
+			// Stories removed by an earlier traversal are only left in the list to save searching for them
+			if (!destroyedSolution.roadmap.isAssigned(randomStory))
+				continue;
+
+			// Remove the story and its dependencies
+			traverseDependenciesBF(randomStory, destroyedSolution, numberOfStoriesToRemove, visitStamps, ++traversals, queue);
+		}
+	}
+
+	// Randomly selects stories to remove
+	static void randomRuin(const Roadmap &completeSolution, int numberOfStoriesToRemove, const vector<int> *ruinCandidates, DestroyedRoadmap &destroyedSolution, ScratchArena &arena) {
+		STATS_TIMER(TIMER_RANDOM_RUIN);
+
+		destroyedSolution.roadmap = completeSolution;
+		destroyedSolution.resetScratch(&arena, numberOfStoriesToRemove);
+
+		Roadmap &roadmap = destroyedSolution.roadmap;
+		int numberOfStories = completeSolution.numberOfStories();
+
+		// Used to randomly select stories without replacement
+		ArenaAllocator<int> allocator(&arena);
+		ScratchVector<int> stories(allocator);
+		ruinStartingStories(ruinCandidates, numberOfStories, stories);
+
+		while (destroyedSolution.removedStories.size() < numberOfStoriesToRemove) {
+			int randomPosition = randomInt(0, stories.size() - 1);
+			int randomStory = stories[randomPosition];
+
+			// Remove the story from the list of unremoved stories
+			stories[randomPosition] = stories.back();
+			stories.pop_back();
+
+			// Add to the list of moves (which will be checked against the tabu list later)
+			destroyedSolution.moves.push_back(Move(randomStory, roadmap.assignedSprints[randomStory]));
+			destroyedSolution.removedStories.push_back(randomStory);
+
+			roadmap.removeStoryFromSprint(randomStory);
+		}
+	}
+
+	// Adds the story to the earliest sprint where it will fit & have its dependencies fulfilled (or else the product backlog)
+	// and returns the position of that sprint
+	static int greedyInsertStory(int storyNumber, Roadmap &roadmap) {
+		int backlogSprint = roadmap.backlogSprint();
+
+		for (int sprint = 0; sprint < roadmap.numberOfSprints(); ++sprint) {
+			if (sprint == backlogSprint || roadmap.validInsert(storyNumber, sprint)) {
+				roadmap.addStoryToSprint(storyNumber, sprint);
+				return sprint;
+			}
+		}
+
+		return -1;
+	}
+
+	// Adds the list of stories to the earliest sprint where they will fit & have their dependencies fulfilled
+	static RepairedRoadmap greedyInsertStories(vector<int> storiesToInsert, Roadmap roadmap) {
+		// The list of moves that repaired the destroyed solution
+		ScratchVector<Move> moves;
+
+		for (int storyNumber : storiesToInsert) {
+			// Add to the list of moves (which will be checked against the tabu list later)
+			moves.push_back(Move(storyNumber, greedyInsertStory(storyNumber, roadmap)));
+		}
+
+		return RepairedRoadmap(roadmap, moves);
+	}
+
+	// Repair a partly destroyed solution to a complete solution
+	// (the destroyed roadmap is repaired in place and swapped into the repaired solution, so it's left empty)
+	static void greedyRepair(DestroyedRoadmap &destroyedSolution, RepairedRoadmap &repairedSolution, ScratchArena &arena) {
+		STATS_TIMER(TIMER_REPAIR);
+
+		sort(destroyedSolution.removedStories.begin(), destroyedSolution.removedStories.end(), StoryGreedySorting(destroyedSolution.roadmap.instance.get()));
+
+		swap(repairedSolution.roadmap, destroyedSolution.roadmap);
+		repairedSolution.resetScratch(&arena, destroyedSolution.removedStories.size());
+
+		for (int storyNumber : destroyedSolution.removedStories) {
+			// Add to the list of moves (which will be checked against the tabu list later)
+			repairedSolution.moves.push_back(Move(storyNumber, greedyInsertStory(storyNumber, repairedSolution.roadmap)));
+		}
+	}
+
+	// Repairs by packing each sprint in turn, earliest first, with the most valuable set of removed stories that fits in its spare capacity
+	// (a 0/1 knapsack, keeping each story's take/leave decisions as a bitset over the capacities to recover the chosen set).
+	// Stories can go in a sprint once all of their dependencies are in earlier sprints, and equally valuable sets are told apart by
+	// how many dependees they unblock. Whatever the knapsacks leave out is inserted greedily
+	static void knapsackRepair(DestroyedRoadmap &destroyedSolution, RepairedRoadmap &repairedSolution, ScratchArena &arena) {
+		STATS_TIMER(TIMER_REPAIR);
+
+		const ProblemInstance &problem = *destroyedSolution.roadmap.instance;
+		int numberOfRemovedStories = destroyedSolution.removedStories.size();
+
+		swap(repairedSolution.roadmap, destroyedSolution.roadmap);
+		repairedSolution.resetScratch(&arena, numberOfRemovedStories);
+
+		Roadmap &roadmap = repairedSolution.roadmap;
+
+		// Everything is sized for the largest sprint and all of the removed stories, so the arena needs the same room every iteration
+		int words = problem.maxSprintCapacity / 64 + 1;
+		ScratchVector<long long> bestValues(problem.maxSprintCapacity + 1, 0, ArenaAllocator<long long>(&arena));
+		ScratchVector<unsigned long long> decisions((size_t)numberOfRemovedStories * words, 0, ArenaAllocator<unsigned long long>(&arena));
+
+		// Stories still to insert, and the positions in that list of the ones that can go in the current sprint
+		ArenaAllocator<int> allocator(&arena);
+		ScratchVector<int> remainingStories(destroyedSolution.removedStories.begin(), destroyedSolution.removedStories.end(), allocator);
+		ScratchVector<int> eligibleStories(allocator);
+		eligibleStories.reserve(numberOfRemovedStories);
+
+		for (int sprint = 0; sprint < roadmap.numberOfSprints() && !remainingStories.empty(); ++sprint) {
+			if (sprint == problem.backlogSprint)
+				continue;
+
+			int capacity = problem.sprintCapacities[sprint] - roadmap.sprintLoads[sprint];
+
+			if (capacity < 0)
+				continue;
+
+			eligibleStories.clear();
+
+			for (int i = 0; i < remainingStories.size(); ++i) {
+				if (roadmap.validInsert(remainingStories[i], sprint))
+					eligibleStories.push_back(i);
+			}
+
+			if (eligibleStories.empty())
+				continue;
+
+			fill(bestValues.begin(), bestValues.begin() + capacity + 1, 0);
+
+			for (int i = 0; i < eligibleStories.size(); ++i) {
+				int storyNumber = remainingStories[eligibleStories[i]];
+				int storyPoints = problem.graph->storyPoints[storyNumber];
+				long long value = (long long)problem.storyValues[storyNumber] * (problem.numberOfStories + 1) + problem.dependees(storyNumber).size();
+
+				unsigned long long *taken = decisions.data() + (size_t)i * words;
+				fill(taken, taken + capacity / 64 + 1, 0);
+
+				for (int c = capacity; c >= storyPoints; --c) {
+					if (bestValues[c - storyPoints] + value > bestValues[c]) {
+						bestValues[c] = bestValues[c - storyPoints] + value;
+						taken[c / 64] |= 1ULL << (c % 64);
+					}
+				}
+			}
+
+			// Follow the decisions back from the full capacity to find the chosen stories
+			int c = capacity;
+
+			for (int i = eligibleStories.size() - 1; i >= 0; --i) {
+				if ((decisions[(size_t)i * words + c / 64] >> (c % 64)) & 1) {
+					int storyNumber = remainingStories[eligibleStories[i]];
+
+					roadmap.addStoryToSprint(storyNumber, sprint);
+					repairedSolution.moves.push_back(Move(storyNumber, sprint));
+
+					c -= problem.graph->storyPoints[storyNumber];
+					remainingStories[eligibleStories[i]] = -1;
+				}
+			}
+
+			remainingStories.erase(remove(remainingStories.begin(), remainingStories.end(), -1), remainingStories.end());
+		}
+
+		sort(remainingStories.begin(), remainingStories.end(), StoryGreedySorting(&problem));
+
+		for (int storyNumber : remainingStories)
+			repairedSolution.moves.push_back(Move(storyNumber, greedyInsertStory(storyNumber, roadmap)));
+	}
+
+	// Returns whether the temporary solution should become the new current solution
+	static bool accept(const RepairedRoadmap &repairedSolution, int repairedSolutionValue, int currentSolutionValue, double temperature, int currentIteration, TabuList *tabuList) {
+		STATS_TIMER(TIMER_ACCEPT);
+
+		double delta = repairedSolutionValue - currentSolutionValue;
+
+		// Always accept an improving solution (part of the simulated annealing acceptance and tabu aspiration criteria)
+		if (delta > 0)
+			return true;
+
+		// Check if any of the moves made during the repair are tabu
+		for (Move move : repairedSolution.moves) {
+			// Don't accept the repaired solution if one of the moves is tabu
+			if (tabuList->isTabu(move, currentIteration)) {
+				STATS_COUNT(COUNTER_TABU_HITS);
+				return false;
+			}
+		}
+
+		// Accept non-improving moves with probability related to the annealing temperature
+		if (exp(delta / temperature) > randomDouble(0, 1))
+			return true;
+
+		// Didn't meet any of the expected criteria above, just reject the new solution
+		return false;
+	}
+
+	// Improves the roadmap by shifting single stories to sprints with a bigger bonus, or by swapping them with a less valuable story
+	// in such a sprint, until no move improves it or the evaluation budget runs out. Returns the value gained
+	// A move's change in value only depends on the stories' business values and the two sprints' bonuses, and its feasibility on the
+	// two sprints' cached loads and the moved stories' dependencies, so each move is checked without looking at the rest of the roadmap
+	static int localSearch(Roadmap &roadmap, long long maxEvaluations) {
+		STATS_TIMER(TIMER_LOCAL_SEARCH);
+
+		const ProblemInstance &problem = *roadmap.instance;
+		int numberOfStories = roadmap.numberOfStories();
+		int numberOfSprints = roadmap.numberOfSprints();
+
+		// Sprints from the biggest bonus to the smallest, so the first feasible shift of a story is its best one
+		vector<int> sprintsByBonus(numberOfSprints);
+
+		for (int sprint = 0; sprint < numberOfSprints; ++sprint)
+			sprintsByBonus[sprint] = sprint;
+
+		sort(sprintsByBonus.begin(), sprintsByBonus.end(), [&problem](int a, int b) { return problem.sprintBonus(a) > problem.sprintBonus(b); });
+
+		// The stories in each sprint, and where each story is in its sprint's list, to find swap partners without scanning every story
+		vector<vector<int>> sprintStories(numberOfSprints);
+		vector<int> sprintStoryPositions(numberOfStories, -1);
+
+		for (int storyNumber = 0; storyNumber < numberOfStories; ++storyNumber) {
+			int sprint = roadmap.assignedSprints[storyNumber];
+
+			if (sprint != -1) {
+				sprintStoryPositions[storyNumber] = sprintStories[sprint].size();
+				sprintStories[sprint].push_back(storyNumber);
+			}
+		}
+
+		auto moveStory = [&](int storyNumber, int to) {
+			vector<int> &fromStories = sprintStories[roadmap.assignedSprints[storyNumber]];
+
+			// Fill the story's place with the last story in the sprint
+			int position = sprintStoryPositions[storyNumber];
+			fromStories[position] = fromStories.back();
+			sprintStoryPositions[fromStories[position]] = position;
+			fromStories.pop_back();
+
+			sprintStoryPositions[storyNumber] = sprintStories[to].size();
+			sprintStories[to].push_back(storyNumber);
+
+			roadmap.moveStory(storyNumber, to);
+		};
+
+		int valueGained = 0;
+		long long evaluations = 0;
+		bool improved = true;
+
+		while (improved && evaluations < maxEvaluations) {
+			improved = false;
+
+			for (int storyNumber = 0; storyNumber < numberOfStories && evaluations < maxEvaluations; ++storyNumber) {
+				int from = roadmap.assignedSprints[storyNumber];
+				int value = problem.storyValues[storyNumber];
+
+				// Moving a story that delivers nothing can't gain anything
+				if (from == -1 || value <= 0)
+					continue;
+
+				int fromBonus = problem.sprintBonus(from);
+				bool moved = false;
+
+				for (int to : sprintsByBonus) {
+					int toBonus = problem.sprintBonus(to);
+
+					// The remaining sprints are no better than the one the story is in
+					if (toBonus <= fromBonus)
+						break;
+
+					++evaluations;
+
+					// Shift the story into the better sprint
+					if (roadmap.validInsert(storyNumber, to)) {
+						moveStory(storyNumber, to);
+						valueGained += value * (toBonus - fromBonus);
+						moved = true;
+						break;
+					}
+
+					// Otherwise swap it with a less valuable story there that makes enough room for it
+					for (int i = 0; i < sprintStories[to].size() && !moved; ++i) {
+						int otherNumber = sprintStories[to][i];
+						int otherValue = problem.storyValues[otherNumber];
+
+						if (otherValue >= value)
+							continue;
+
+						++evaluations;
+
+						long long toLoad = (long long)roadmap.sprintLoads[to] - problem.graph->storyPoints[otherNumber] + problem.graph->storyPoints[storyNumber];
+						long long fromLoad = (long long)roadmap.sprintLoads[from] - problem.graph->storyPoints[storyNumber] + problem.graph->storyPoints[otherNumber];
+
+						if (toLoad > problem.sprintCapacities[to] || fromLoad > problem.sprintCapacities[from])
+							continue;
+
+						// The capacities are fine, so the swap is feasible if it doesn't break any more dependencies,
+						// which the roadmap's violation count tells us after making the swap
+						int precedenceViolations = roadmap.precedenceViolations;
+
+						moveStory(storyNumber, to);
+						moveStory(otherNumber, from);
+
+						if (roadmap.precedenceViolations <= precedenceViolations) {
+							valueGained += (value - otherValue) * (toBonus - fromBonus);
+							moved = true;
+						}
+						else {
+							moveStory(otherNumber, to);
+							moveStory(storyNumber, from);
+						}
+					}
+
+					if (moved)
+						break;
+				}
+
+				improved = improved || moved;
+			}
+		}
+
+		// Every move kept the roadmap feasible (the roadmaps searched are always feasible to begin with)
+		assert(valueGained == 0 || roadmap.isFeasible());
+
+		return valueGained;
+	}
+
+	static Roadmap randomRoadmap(shared_ptr<const ProblemInstance> instance) {
+		vector<int> shuffledStories(instance->numberOfStories);
+
+		for (int i = 0; i < shuffledStories.size(); ++i)
+			shuffledStories[i] = i;
+
+		randomShuffle(shuffledStories);
+		RepairedRoadmap repairedRoadmap = LNS::greedyInsertStories(shuffledStories, Roadmap(instance));
+		return repairedRoadmap.roadmap;
+	}
+
+	static int maxDifference(vector<int> integers) {
+		int minElement = integers[0];
+		int maxElement = integers[0];
+
+		// The maximum difference is the difference between the smallest and largest elements.
+		// So find the min and max integers in the list
+		for (int element : integers) {
+			if (element < minElement)
+				minElement = element;
+			else if (element > maxElement)
+				maxElement = element;
+		}
+
+		return maxElement - minElement;
+	}
+
+	// Estimates a starting temperature from the spread of values of random roadmaps (stopping early once timeLimit seconds have gone, if it's positive)
+	static double calculateInitialTemperature(shared_ptr<const ProblemInstance> instance, int trials, double timeLimit = 0.0) {
+		STATS_TIMER(TIMER_CALIBRATION);
+
+		auto t_start = chrono::steady_clock::now();
+		vector<int> randomSolutionValues;
+
+		for (int i = 0; i < trials; ++i) {
+			randomSolutionValues.push_back(randomRoadmap(instance).calculateValue());
+
+			if (timeLimit > 0 && i > 0 && chrono::duration<double>(chrono::steady_clock::now() - t_start).count() >= timeLimit)
+				break;
+		}
+
+		return maxDifference(randomSolutionValues);
+	}
+
+	// Returns the length of the longest chain of dependencies below each story, i.e. the number of earlier sprints it needs
+	// (stories on a dependency cycle can never be assigned and get a depth of INT_MAX)
+	static vector<int> dependencyDepths(const ProblemInstance &instance) {
+		vector<int> depths(instance.numberOfStories, 0);
+		vector<int> unresolvedDependencies(instance.numberOfStories, 0);
+		queue<int> resolvedStories;
+
+		for (int storyNumber = 0; storyNumber < instance.numberOfStories; ++storyNumber) {
+			unresolvedDependencies[storyNumber] = instance.dependencies(storyNumber).size();
+
+			if (unresolvedDependencies[storyNumber] == 0)
+				resolvedStories.push(storyNumber);
+		}
+
+		// Walk the dependency graph in topological order, pushing each story's depth onto its dependees
+		while (!resolvedStories.empty()) {
+			int storyNumber = resolvedStories.front();
+			resolvedStories.pop();
+
+			for (int dependeeNumber : instance.dependees(storyNumber)) {
+				depths[dependeeNumber] = max(depths[dependeeNumber], depths[storyNumber] + 1);
+
+				if (--unresolvedDependencies[dependeeNumber] == 0)
+					resolvedStories.push(dependeeNumber);
+			}
+		}
+
+		for (int i = 0; i < instance.numberOfStories; ++i) {
+			if (unresolvedDependencies[i] > 0)
+				depths[i] = INT_MAX;
+		}
+
+		return depths;
+	}
+
+	// Returns an upper bound on the total weighted business value of any feasible roadmap.
+	// Two relaxations are computed and the tighter one is used:
+	// - every story in the sprint with the highest bonus that its dependency depth allows, ignoring capacities
+	// - a fractional knapsack over the sprint capacities, filling the highest bonus sprints with the densest stories first
+	static int calculateUpperBound(const ProblemInstance &instance) {
+		// Real sprints in chronological order (the product backlog delivers no value)
+		vector<Sprint> sprints;
+
+		for (Sprint sprint : instance.sprints) {
+			if (sprint.sprintNumber != -1)
+				sprints.push_back(sprint);
+		}
+
+		sort(sprints.begin(), sprints.end());
+
+		// The highest bonus available from each sprint onwards
+		vector<int> laterMaxBonus(sprints.size() + 1, 0);
+
+		for (int i = (int)sprints.size() - 1; i >= 0; --i)
+			laterMaxBonus[i] = max(laterMaxBonus[i + 1], sprints[i].sprintBonus);
+
+		vector<int> depths = dependencyDepths(instance);
+
+		double dependencyBound = 0;
+		double capacityBound = 0;
+
+		// Stories that need capacity and can be assigned somewhere, with their value per story point
+		vector<pair<int, double>> densities;
+
+		for (int storyNumber = 0; storyNumber < instance.numberOfStories; ++storyNumber) {
+			int businessValue = instance.storyValues[storyNumber];
+			int storyPoints = instance.graph->storyPoints[storyNumber];
+
+			// A story needs a distinct earlier sprint for each level of dependencies below it
+			int maxBonus = depths[storyNumber] < sprints.size() ? laterMaxBonus[depths[storyNumber]] : 0;
+
+			if (maxBonus <= 0 || businessValue <= 0)
+				continue;
+
+			dependencyBound += (double)businessValue * maxBonus;
+
+			// Stories without story points never compete for capacity
+			if (storyPoints <= 0)
+				capacityBound += (double)businessValue * maxBonus;
+			else
+				densities.push_back(make_pair(storyNumber, (double)businessValue / storyPoints));
+		}
+
+		sort(densities.begin(), densities.end(), [](pair<int, double> const& a, pair<int, double> const& b) { return a.second > b.second; });
+
+		vector<pair<Sprint, double>> bonuses;
+
+		for (Sprint sprint : sprints)
+			bonuses.push_back(make_pair(sprint, (double)sprint.sprintBonus));
+
+		sort(bonuses.begin(), bonuses.end(), SprintDoublePairDescending());
+
+		// Pour the densest story points into the highest bonus sprints (optimal for the relaxation as value is density * bonus)
+		int storyPosition = 0;
+		double remainingStoryPoints = densities.empty() ? 0 : instance.graph->storyPoints[densities[0].first];
+
+		for (pair<Sprint, double> bonus : bonuses) {
+			double remainingCapacity = bonus.first.sprintCapacity;
+
+			while (remainingCapacity > 0 && storyPosition < densities.size() && bonus.second > 0) {
+				double filled = min(remainingCapacity, remainingStoryPoints);
+
+				capacityBound += filled * densities[storyPosition].second * bonus.second;
+				remainingCapacity -= filled;
+				remainingStoryPoints -= filled;
+
+				if (remainingStoryPoints <= 0 && ++storyPosition < densities.size())
+					remainingStoryPoints = instance.graph->storyPoints[densities[storyPosition].first];
+			}
+		}
+
+		// Solution values are integers so the fractional part of the bound can never be reached
+		return (int)floor(min(dependencyBound, capacityBound) + 1e-6);
+	}
+
+	// Moves the story to the sprint (-1 to unassign it)
+	static void reassignStory(Roadmap &roadmap, int storyNumber, int sprint) {
+		if (roadmap.isAssigned(storyNumber))
+			roadmap.removeStoryFromSprint(storyNumber);
+
+		if (sprint != -1)
+			roadmap.addStoryToSprint(storyNumber, sprint);
+	}
+
+	// Walks from the initiating roadmap towards the guiding one, moving stories one at a time to their sprint in the guiding roadmap
+	// whenever the move keeps the roadmap feasible, until no more can be moved. The best roadmap met at least minimumDistance moves from
+	// both ends (a quarter of the way if not positive) goes into relinked, so that it's neither of the two again. Returns false if there wasn't one
+	static bool pathRelink(const Roadmap &initiating, const Roadmap &guiding, int minimumDistance, Roadmap &relinked) {
+		const ProblemInstance &problem = *initiating.instance;
+		vector<int> differences;
+
+		for (int storyNumber = 0; storyNumber < problem.numberOfStories; ++storyNumber) {
+			if (initiating.assignedSprints[storyNumber] != guiding.assignedSprints[storyNumber])
+				differences.push_back(storyNumber);
+		}
+
+		int distance = differences.size();
+
+		if (minimumDistance <= 0)
+			minimumDistance = distance / 4;
+
+		if (distance < 2 * max(1, minimumDistance))
+			return false;
+
+		// Random order so that relinking the same two elites again takes a different path
+		randomShuffle(differences);
+
+		Roadmap path = initiating;
+		int value = path.calculateValue();
+		int bestValue = INT_MIN;
+		int bestPathLength = 0;
+
+		// Stories in the order they were moved, and -1 in differences for the stories already moved
+		vector<int> moves;
+		bool moved = true;
+
+		while (moved) {
+			moved = false;
+
+			for (int &storyNumber : differences) {
+				if (storyNumber == -1)
+					continue;
+
+				int from = path.assignedSprints[storyNumber];
+				int to = guiding.assignedSprints[storyNumber];
+
+				reassignStory(path, storyNumber, to);
+
+				if (!path.isFeasible()) {
+					reassignStory(path, storyNumber, from);
+					continue;
+				}
+
+				value += problem.storyValues[storyNumber] * (problem.sprintBonus(to) - problem.sprintBonus(from));
+				moves.push_back(storyNumber);
+				storyNumber = -1;
+				moved = true;
+
+				if (moves.size() >= minimumDistance && distance - moves.size() >= minimumDistance && value > bestValue) {
+					bestValue = value;
+					bestPathLength = moves.size();
+				}
+			}
+		}
+
+		if (bestPathLength == 0)
+			return false;
+
+		relinked = initiating;
+
+		for (int i = 0; i < bestPathLength; ++i)
+			reassignStory(relinked, moves[i], guiding.assignedSprints[moves[i]]);
+
+		return true;
+	}
+
+	// Rebuilds a previous roadmap against the current story and sprint data, keeping every assignment that is still valid
+	// and greedily re-inserting the stories that are new or whose assignment became infeasible
+	static Roadmap warmStartRoadmap(shared_ptr<const ProblemInstance> instance, map<int, int> previousAssignments) {
+		Roadmap roadmap(instance);
+
+		// Positions of the sprints in the roadmap
+		map<int, int> sprintsByNumber;
+
+		for (int sprint = 0; sprint < instance->numberOfSprints(); ++sprint)
+			sprintsByNumber[instance->sprintNumbers[sprint]] = sprint;
+
+		// Stories that kept a sprint which still exists, grouped by that sprint's number in chronological order
+		map<int, vector<int>> previousSprintStories;
+		vector<int> storiesToRepair;
+
+		for (int storyNumber = 0; storyNumber < instance->numberOfStories; ++storyNumber) {
+			auto assignment = previousAssignments.find(instance->graph->storyIds[storyNumber]);
+
+			if (assignment != previousAssignments.end() && sprintsByNumber.count(assignment->second))
+				previousSprintStories[assignment->second].push_back(storyNumber);
+			else
+				storiesToRepair.push_back(storyNumber);
+		}
+
+		// The product backlog is never overloaded, so stories left there previously stay there
+		for (int storyNumber : previousSprintStories[-1])
+			roadmap.addStoryToSprint(storyNumber, roadmap.backlogSprint());
+
+		previousSprintStories.erase(-1);
+
+		// Replaying earlier sprints first means dependencies are always in place before the stories that need them,
+		// and replaying the most valuable stories of a sprint first keeps them if the sprint's capacity was cut
+		for (pair<const int, vector<int>> &sprintStories : previousSprintStories) {
+			int sprint = sprintsByNumber[sprintStories.first];
+
+			sort(sprintStories.second.begin(), sprintStories.second.end(), StoryGreedySorting(instance.get()));
+
+			for (int storyNumber : sprintStories.second) {
+				if (roadmap.validInsert(storyNumber, sprint))
+					roadmap.addStoryToSprint(storyNumber, sprint);
+				else
+					storiesToRepair.push_back(storyNumber);
+			}
+		}
+
+		sort(storiesToRepair.begin(), storiesToRepair.end(), StoryGreedySorting(instance.get()));
+		return greedyInsertStories(storiesToRepair, roadmap).roadmap;
+	}
+
+	// Greedily assigns the stories left in the product backlog, if possible
+	static Roadmap assignBacklogStories(Roadmap roadmap) {
+		if (roadmap.numberOfSprints() == 0)
+			return roadmap;
+
+		vector<int> unassignedStories;
+
+		// Remove the stories from the 'backlog' sprint
+		for (int storyNumber : roadmap.storiesInSprint(roadmap.backlogSprint())) {
+			unassignedStories.push_back(storyNumber);
+			roadmap.removeStoryFromSprint(storyNumber);
+		}
+
+		// If there are stories assigned to the backlog, try to assign them greedily
+		if (unassignedStories.empty())
+			return roadmap;
+
+		sort(unassignedStories.begin(), unassignedStories.end(), StoryGreedySorting(roadmap.instance.get()));
+		return greedyInsertStories(unassignedStories, roadmap).roadmap;
+	}
+
+	// Searches from a random roadmap, or continues from the warm start solution if one is given
+	// (restarts then go back to the warm start solution rather than a random roadmap so the plan doesn't churn).
+	// Runs the build of the engine (see LNSEngine) with the policies named in the parameters
+	static Roadmap run(shared_ptr<const ProblemInstance> instance, LNSParameters parameters, Roadmap *warmStartSolution = NULL, LNSWorkspace *workspace = NULL);
+
+	// Contracts the problem into super-stories of at most the given number of story points, with the summed value and points of their stories:
+	// - chains: a story and the one story that depends on it, when it's that story's only dependency
+	// - clusters: stories of the same dependency depth, grouped by their first dependency and then by value density so that similar stories go together
+	// Stories of the same depth never depend on each other (even indirectly), and a chain is only ever entered at its first story and left at its last,
+	// so the super-stories' dependencies are acyclic whenever the stories' are
+	static CoarseLevel coarsen(const ProblemInstance &fine, int maxSuperStoryPoints) {
+		CoarseLevel level;
+		level.superStories.assign(fine.numberOfStories, -1);
+
+		int numberOfSuperStories = 0;
+
+		for (int storyNumber = 0; storyNumber < fine.numberOfStories; ++storyNumber) {
+			if (level.superStories[storyNumber] != -1 || fine.dependees(storyNumber).size() != 1)
+				continue;
+
+			int dependentNumber = *fine.dependees(storyNumber).begin();
+
+			if (dependentNumber == storyNumber || level.superStories[dependentNumber] != -1 || fine.dependencies(dependentNumber).size() != 1
+				|| fine.graph->storyPoints[storyNumber] + fine.graph->storyPoints[dependentNumber] > maxSuperStoryPoints)
+				continue;
+
+			level.superStories[storyNumber] = numberOfSuperStories;
+			level.superStories[dependentNumber] = numberOfSuperStories;
+			++numberOfSuperStories;
+		}
+
+		vector<int> depths = dependencyDepths(fine);
+		vector<int> clusteredStories;
+
+		for (int storyNumber = 0; storyNumber < fine.numberOfStories; ++storyNumber) {
+			if (level.superStories[storyNumber] != -1)
+				continue;
+
+			// Stories on a dependency cycle can never be assigned, so there's no point grouping them
+			if (depths[storyNumber] == INT_MAX)
+				level.superStories[storyNumber] = numberOfSuperStories++;
+			else
+				clusteredStories.push_back(storyNumber);
+		}
+
+		auto firstDependency = [&fine](int storyNumber) {
+			return fine.dependencies(storyNumber).size() > 0 ? *fine.dependencies(storyNumber).begin() : -1;
+		};
+
+		sort(clusteredStories.begin(), clusteredStories.end(), [&](int a, int b) {
+			if (depths[a] != depths[b])
+				return depths[a] < depths[b];
+
+			if (firstDependency(a) != firstDependency(b))
+				return firstDependency(a) < firstDependency(b);
+
+			// Higher value per story point first (stories without points count as the densest)
+			long long aDensity = (long long)fine.storyValues[a] * fine.graph->storyPoints[b];
+			long long bDensity = (long long)fine.storyValues[b] * fine.graph->storyPoints[a];
+
+			return aDensity != bDensity ? aDensity > bDensity : a < b;
+		});
+
+		int superStoryPoints = 0;
+
+		for (int i = 0; i < clusteredStories.size(); ++i) {
+			int storyNumber = clusteredStories[i];
+			int storyPoints = fine.graph->storyPoints[storyNumber];
+
+			if (i == 0 || depths[storyNumber] != depths[clusteredStories[i - 1]] || superStoryPoints + storyPoints > maxSuperStoryPoints) {
+				++numberOfSuperStories;
+				superStoryPoints = 0;
+			}
+
+			level.superStories[storyNumber] = numberOfSuperStories - 1;
+			superStoryPoints += storyPoints;
+		}
+
+		// The stories of each super-story, in compressed sparse row form
+		vector<int> memberOffsets(numberOfSuperStories + 1, 0);
+		vector<int> members(fine.numberOfStories);
+
+		for (int storyNumber = 0; storyNumber < fine.numberOfStories; ++storyNumber)
+			++memberOffsets[level.superStories[storyNumber] + 1];
+
+		for (int i = 0; i < numberOfSuperStories; ++i)
+			memberOffsets[i + 1] += memberOffsets[i];
+
+		vector<int> nextMember(memberOffsets.begin(), memberOffsets.end() - 1);
+
+		for (int storyNumber = 0; storyNumber < fine.numberOfStories; ++storyNumber)
+			members[nextMember[level.superStories[storyNumber]]++] = storyNumber;
+
+		vector<Story> superStoryData;
+		vector<int> linkStamps(numberOfSuperStories, -1);
+
+		for (int superStory = 0; superStory < numberOfSuperStories; ++superStory)
+			superStoryData.push_back(Story(superStory, 0, 0));
+
+		for (int superStory = 0; superStory < numberOfSuperStories; ++superStory) {
+			Story &story = superStoryData[superStory];
+
+			for (int i = memberOffsets[superStory]; i < memberOffsets[superStory + 1]; ++i) {
+				int storyNumber = members[i];
+
+				story.businessValue += fine.storyValues[storyNumber];
+				story.storyPoints += fine.graph->storyPoints[storyNumber];
+
+				// Dependencies between stories of the same super-story disappear, and the rest are only recorded once
+				for (int dependencyNumber : fine.dependencies(storyNumber)) {
+					int dependency = level.superStories[dependencyNumber];
+
+					if (dependency != superStory && linkStamps[dependency] != superStory) {
+						linkStamps[dependency] = superStory;
+						story.dependencies.push_back(dependency);
+						superStoryData[dependency].dependees.push_back(superStory);
+					}
+				}
+			}
+		}
+
+		level.instance = make_shared<ProblemInstance>(superStoryData, fine.sprints);
+		return level;
+	}
+
+	// Turns a roadmap of a coarse level into one of the level below. Dependencies first, each story goes into the earliest sprint it fits
+	// from its super-story's sprint onwards, and then whatever room is left is filled greedily from the product backlog.
+	// The stories whose place the coarse roadmap didn't settle (split from the rest of their super-story, or only placed by the fill)
+	// and their neighbours in the dependency graph are returned in boundaryStories
+	static Roadmap projectRoadmap(const Roadmap &coarseSolution, const CoarseLevel &level, shared_ptr<const ProblemInstance> fine, vector<int> &boundaryStories) {
+		Roadmap roadmap(fine);
+		int backlogSprint = roadmap.backlogSprint();
+
+		// Stories sorted by dependency depth are in dependency order
+		vector<int> depths = dependencyDepths(*fine);
+		vector<int> storiesInOrder(fine->numberOfStories);
+
+		for (int i = 0; i < storiesInOrder.size(); ++i)
+			storiesInOrder[i] = i;
+
+		StoryGreedySorting greedySorting(fine.get());
+
+		sort(storiesInOrder.begin(), storiesInOrder.end(), [&](int a, int b) {
+			return depths[a] != depths[b] ? depths[a] < depths[b] : greedySorting(a, b);
+		});
+
+		vector<bool> splitSuperStories(coarseSolution.numberOfStories(), false);
+		vector<int> unassignedStories;
+
+		for (int storyNumber : storiesInOrder) {
+			int superStory = level.superStories[storyNumber];
+			int coarseSprint = coarseSolution.assignedSprints[superStory];
+			int sprint = -1;
+
+			if (coarseSprint != -1 && coarseSprint != backlogSprint) {
+				for (int laterSprint = coarseSprint; laterSprint < roadmap.numberOfSprints() && sprint == -1; ++laterSprint) {
+					if (laterSprint != backlogSprint && roadmap.validInsert(storyNumber, laterSprint))
+						sprint = laterSprint;
+				}
+
+				if (sprint != coarseSprint)
+					splitSuperStories[superStory] = true;
+			}
+
+			if (sprint != -1)
+				roadmap.addStoryToSprint(storyNumber, sprint);
+			else
+				unassignedStories.push_back(storyNumber);
+		}
+
+		vector<bool> isBoundary(fine->numberOfStories, false);
+
+		// Stories the coarse roadmap left out can still fit in the gaps between the super-stories
+		sort(unassignedStories.begin(), unassignedStories.end(), greedySorting);
+
+		for (int storyNumber : unassignedStories) {
+			if (greedyInsertStory(storyNumber, roadmap) != backlogSprint)
+				isBoundary[storyNumber] = true;
+		}
+
+		for (int storyNumber = 0; storyNumber < fine->numberOfStories; ++storyNumber) {
+			if (splitSuperStories[level.superStories[storyNumber]])
+				isBoundary[storyNumber] = true;
+		}
+
+		for (int storyNumber = 0; storyNumber < fine->numberOfStories; ++storyNumber) {
+			if (!isBoundary[storyNumber])
+				continue;
+
+			boundaryStories.push_back(storyNumber);
+
+			for (int dependencyNumber : fine->dependencies(storyNumber)) {
+				if (!isBoundary[dependencyNumber])
+					boundaryStories.push_back(dependencyNumber);
+			}
+
+			for (int dependeeNumber : fine->dependees(storyNumber)) {
+				if (!isBoundary[dependeeNumber])
+					boundaryStories.push_back(dependeeNumber);
+			}
+		}
+
+		// A neighbour of several boundary stories is only listed once
+		sort(boundaryStories.begin(), boundaryStories.end());
+		boundaryStories.erase(unique(boundaryStories.begin(), boundaryStories.end()), boundaryStories.end());
+
+		return roadmap;
+	}
+
+	// Solves very large problems by coarsening them level by level into problems of super-stories until there are at most coarseSize stories,
+	// solving the coarsest problem and then projecting its roadmap back down a level at a time, refining each projection with a search
+	// that only starts from the stories whose place wasn't settled by the level above
+	static Roadmap runMultilevel(shared_ptr<const ProblemInstance> instance, LNSParameters parameters, int coarseSize) {
+		// Super-stories start small and are allowed to grow up to half an average sprint, so the coarse roadmaps can still pack the sprints
+		long long totalCapacity = 0;
+		int numberOfRealSprints = 0;
+
+		for (int sprint = 0; sprint < instance->numberOfSprints(); ++sprint) {
+			if (sprint != instance->backlogSprint) {
+				totalCapacity += instance->sprintCapacities[sprint];
+				++numberOfRealSprints;
+			}
+		}
+
+		int maxSuperStoryPoints = numberOfRealSprints > 0 ? max(1LL, totalCapacity / numberOfRealSprints / 2) : 1;
+		int superStoryPoints = max(1, maxSuperStoryPoints / 4);
+
+		// instances[0] is the problem itself, and levels[i] takes instances[i] to instances[i + 1]
+		vector<shared_ptr<const ProblemInstance>> instances(1, instance);
+		vector<CoarseLevel> levels;
+
+		while (instances.back()->numberOfStories > coarseSize) {
+			CoarseLevel level = coarsen(*instances.back(), superStoryPoints);
+
+			// A level that barely shrinks the problem isn't worth refining
+			bool shrunk = level.instance->numberOfStories <= 0.9 * instances.back()->numberOfStories;
+
+			if (shrunk) {
+				instances.push_back(level.instance);
+				levels.push_back(level);
+			}
+
+			if (superStoryPoints < maxSuperStoryPoints)
+				superStoryPoints = min(maxSuperStoryPoints, 2 * superStoryPoints);
+			else if (!shrunk)
+				break;
+		}
+
+		// Even the coarsest problem can have thousands of super-stories when the sprints only have room for a small part of the backlog,
+		// so each level's search budget goes with the number of stories it searches from rather than with the stories times the sprints
+		shared_ptr<const ProblemInstance> coarsestInstance = instances.back();
+		LNSParameters coarsestParameters = parameters;
+
+		if (coarsestParameters.startTemperature <= 0)
+			coarsestParameters.startTemperature = max(1.0, calculateInitialTemperature(coarsestInstance, max(1.0, parameters.iterationBudget * coarsestInstance->numberOfStories)));
+
+		if (coarsestParameters.maxIterations <= 0)
+			coarsestParameters.maxIterations = max(1.0, 2 * coarsestInstance->numberOfStories * parameters.iterationBudget);
+
+		// The levels share the buffers of the search, which are sized for the largest problem by the last refinement
+		LNSWorkspace workspace;
+		Roadmap solution = run(coarsestInstance, coarsestParameters, NULL, &workspace);
+
+		for (int i = levels.size() - 1; i >= 0; --i) {
+			vector<int> boundaryStories;
+			Roadmap projectedSolution = projectRoadmap(solution, levels[i], instances[i], boundaryStories);
+
+			if (boundaryStories.empty()) {
+				solution = projectedSolution;
+				continue;
+			}
+
+			// The projection is already a good roadmap, so the refinement starts cold rather than calibrating a temperature from random ones
+			LNSParameters refinementParameters = parameters;
+			refinementParameters.ruinCandidates = make_shared<const vector<int>>(boundaryStories);
+			refinementParameters.startTemperature = 1.0;
+			refinementParameters.maxIterations = max(1.0, 2 * boundaryStories.size() * parameters.iterationBudget);
+
+			solution = run(instances[i], refinementParameters, &projectedSolution, &workspace);
+		}
+
+		return solution;
+	}
+
+	// Replica exchange: runs a search per replica on its own thread, each at a fixed temperature of a geometric ladder from 1 up to the
+	// calibrated starting temperature, for exchangeInterval iterations at a time. Between rounds, replicas at neighbouring temperatures
+	// swap temperatures by the Metropolis criterion, so good solutions found by the hot replicas sink down to the cold ones. Replicas never
+	// restart from random roadmaps, and each keeps its own roadmap and tabu list wherever its temperature moves to
+	static Roadmap runParallelTempering(shared_ptr<const ProblemInstance> instance, LNSParameters parameters, int numberOfReplicas, int exchangeInterval) {
+		auto t_start = chrono::steady_clock::now();
+
+		int problemSize = instance->numberOfStories * instance->numberOfSprints();
+		int maxIterations = parameters.maxIterations > 0 ? parameters.maxIterations : 2 * problemSize * parameters.iterationBudget;
+		int upperBound = parameters.upperBound >= 0 ? parameters.upperBound : calculateUpperBound(*instance);
+		double targetValue = upperBound * (1.0 - parameters.optimalityGap);
+
+		// Calibrated once for the whole ladder, rather than by every replica's search
+		double hottest = parameters.startTemperature > 0 ? parameters.startTemperature
+			: max(1.0, calculateInitialTemperature(instance, max(1.0, parameters.iterationBudget * problemSize), parameters.timeLimit / 10));
+
+		vector<double> ladder(numberOfReplicas, 1.0);
+
+		for (int position = 1; position < numberOfReplicas; ++position)
+			ladder[position] = pow(hottest, (double)position / (numberOfReplicas - 1));
+
+		// The replica at each position of the ladder, and the position of each replica
+		vector<int> replicaAt(numberOfReplicas), positions(numberOfReplicas);
+		vector<unique_ptr<LNSWorkspace>> replicas;
+
+		for (int replica = 0; replica < numberOfReplicas; ++replica) {
+			replicaAt[replica] = replica;
+			positions[replica] = replica;
+			replicas.push_back(unique_ptr<LNSWorkspace>(new LNSWorkspace()));
+		}
+
+		// Each round is a short continuation of every replica's search at its current temperature, which cooling mustn't change
+		// and restarts mustn't throw away. The replicas are all of the same problem, so they share the bound worked out above
+		LNSParameters roundParameters = parameters;
+		roundParameters.upperBound = upperBound;
+		roundParameters.coolingPolicy = "geometric";
+		roundParameters.coolingRate = 1.0;
+		roundParameters.maxNonImprovingFraction = 2.0;
+		roundParameters.useLocalSearch = false;
+		roundParameters.checkpointFileName = "";
+
+		ParallelTasks replicaTasks;
+		replicaTasks.resize(numberOfReplicas);
+
+		for (int round = 0, iterations = 0; iterations < maxIterations; ++round, iterations += exchangeInterval) {
+			// The first round always runs, if only for an iteration, so that every replica has a roadmap
+			if (parameters.timeLimit > 0) {
+				roundParameters.timeLimit = parameters.timeLimit - chrono::duration<double>(chrono::steady_clock::now() - t_start).count();
+
+				if (roundParameters.timeLimit <= 0 && round > 0)
+					break;
+
+				roundParameters.timeLimit = max(roundParameters.timeLimit, 1e-9);
+			}
+
+			roundParameters.maxIterations = min(exchangeInterval, maxIterations - iterations);
+			roundParameters.continueSearch = round > 0;
+
+			replicaTasks.run([&](int replica) {
+				LNSParameters replicaParameters = roundParameters;
+				replicaParameters.startTemperature = ladder[positions[replica]];
+
+				run(instance, replicaParameters, NULL, replicas[replica].get());
+			});
+
+			vector<int> currentValues(numberOfReplicas);
+			bool targetReached = false;
+
+			for (int replica = 0; replica < numberOfReplicas; ++replica) {
+				currentValues[replica] = replicas[replica]->currentSolution.calculateValue();
+				targetReached = targetReached || replicas[replica]->bestSolution.calculateValue() >= targetValue;
+			}
+
+			if (targetReached)
+				break;
+
+			// Pairs of neighbouring temperatures take turns to be offered an exchange, (0, 1), (2, 3)... and then (1, 2), (3, 4)...
+			for (int position = round % 2; position + 1 < numberOfReplicas; position += 2) {
+				int colder = replicaAt[position];
+				int hotter = replicaAt[position + 1];
+
+				// Always exchange when the hotter replica has the better roadmap
+				double exponent = (1.0 / ladder[position] - 1.0 / ladder[position + 1]) * (currentValues[hotter] - currentValues[colder]);
+
+				if (exponent >= 0 || exp(exponent) > randomDouble(0, 1)) {
+					STATS_COUNT(COUNTER_EXCHANGES);
+
+					swap(replicaAt[position], replicaAt[position + 1]);
+					positions[colder] = position + 1;
+					positions[hotter] = position;
+				}
+			}
+		}
+
+		int bestReplica = 0;
+
+		for (int replica = 1; replica < numberOfReplicas; ++replica) {
+			if (replicas[replica]->bestSolution.calculateValue() > replicas[bestReplica]->bestSolution.calculateValue())
+				bestReplica = replica;
+		}
+
+		Roadmap bestSolution = replicas[bestReplica]->bestSolution;
+
+		if (parameters.useLocalSearch)
+			localSearch(bestSolution, problemSize);
+
+		return bestSolution;
+	}
+};
+
+// Policies the LNS engine is built from (see LNSEngine). Each is a class of static functions, so that the compiler can inline them
+// into the engine's loop and every combination of policies gets a loop of its own, without virtual calls or checking modes as it goes
+
+// Ruin policies remove the given number of stories from a copy of the complete solution. The step counts the ruins done, so that
+// a policy can take turns between operators
+class RadialRuinPolicy {
+public:
+	static const char *name() {
+		return "radial";
+	}
+
+	static void ruin(const Roadmap &completeSolution, int numberOfStoriesToRemove, const vector<int> *ruinCandidates, int, DestroyedRoadmap &destroyedSolution, ScratchArena &arena) {
+		LNS::radialRuin(completeSolution, numberOfStoriesToRemove, ruinCandidates, destroyedSolution, arena);
+	}
+};
+
+class RandomRuinPolicy {
+public:
+	static const char *name() {
+		return "random";
+	}
+
+	static void ruin(const Roadmap &completeSolution, int numberOfStoriesToRemove, const vector<int> *ruinCandidates, int, DestroyedRoadmap &destroyedSolution, ScratchArena &arena) {
+		LNS::randomRuin(completeSolution, numberOfStoriesToRemove, ruinCandidates, destroyedSolution, arena);
+	}
+};
+
+// Radial and random ruins in turn (the default)
+class AlternatingRuinPolicy {
+public:
+	static const char *name() {
+		return "alternating";
+	}
+
+	static void ruin(const Roadmap &completeSolution, int numberOfStoriesToRemove, const vector<int> *ruinCandidates, int step, DestroyedRoadmap &destroyedSolution, ScratchArena &arena) {
+		if (step % 2 == 0)
+			LNS::radialRuin(completeSolution, numberOfStoriesToRemove, ruinCandidates, destroyedSolution, arena);
+		else
+			LNS::randomRuin(completeSolution, numberOfStoriesToRemove, ruinCandidates, destroyedSolution, arena);
+	}
+};
+
+// Repair policies put the removed stories back into the destroyed solution
+class KnapsackRepairPolicy {
+public:
+	static const char *name() {
+		return "knapsack";
+	}
+
+	static void repair(DestroyedRoadmap &destroyedSolution, RepairedRoadmap &repairedSolution, ScratchArena &arena) {
+		LNS::knapsackRepair(destroyedSolution, repairedSolution, arena);
+	}
+};
+
+class GreedyRepairPolicy {
+public:
+	static const char *name() {
+		return "greedy";
+	}
+
+	static void repair(DestroyedRoadmap &destroyedSolution, RepairedRoadmap &repairedSolution, ScratchArena &arena) {
+		LNS::greedyRepair(destroyedSolution, repairedSolution, arena);
+	}
+};
+
+// Acceptance policies decide whether a repaired solution replaces the current one
+class AnnealingAcceptancePolicy {
+public:
+	static const char *name() {
+		return "annealing";
+	}
+
+	static bool accept(const RepairedRoadmap &repairedSolution, int repairedSolutionValue, int currentSolutionValue, double temperature, int currentIteration, TabuList *tabuList) {
+		return LNS::accept(repairedSolution, repairedSolutionValue, currentSolutionValue, temperature, currentIteration, tabuList);
+	}
+};
+
+// Never goes downhill: accepts improving solutions, and equally good ones that don't undo a tabu move
+class ImprovingAcceptancePolicy {
+public:
+	static const char *name() {
+		return "improving";
+	}
+
+	static bool accept(const RepairedRoadmap &repairedSolution, int repairedSolutionValue, int currentSolutionValue, double, int currentIteration, TabuList *tabuList) {
+		STATS_TIMER(TIMER_ACCEPT);
+
+		if (repairedSolutionValue > currentSolutionValue)
+			return true;
+
+		if (repairedSolutionValue < currentSolutionValue)
+			return false;
+
+		for (Move move : repairedSolution.moves) {
+			if (tabuList->isTabu(move, currentIteration)) {
+				STATS_COUNT(COUNTER_TABU_HITS);
+				return false;
+			}
+		}
+
+		return true;
+	}
+};
+
+// Cooling policies give the annealing temperature for the next iteration
+class GeometricCoolingPolicy {
+public:
+	static const char *name() {
+		return "geometric";
+	}
+
+	static double cool(double temperature, double, int, int, double coolingRate) {
+		return temperature * coolingRate;
+	}
+};
+
+// Falls in a straight line from the start temperature to nothing at the end of the search
+class LinearCoolingPolicy {
+public:
+	static const char *name() {
+		return "linear";
+	}
+
+	static double cool(double, double startTemperature, int currentIteration, int maxIterations, double) {
+		return startTemperature * max(0.0, 1.0 - (double)(currentIteration + 1) / maxIterations);
+	}
+};
+
+// The large neighbourhood search, built from a ruin, repair, acceptance and cooling policy
+template <class RuinPolicy, class RepairPolicy, class AcceptancePolicy, class CoolingPolicy>
+class LNSEngine {
+public:
+	// Ruins a copy of the complete solution and repairs it into the candidate
+	static void buildCandidate(const Roadmap &completeSolution, int numberOfStoriesToRemove, const vector<int> *ruinCandidates, int step, Candidate &candidate) {
+		// Nothing from the candidate's previous iteration's scratch data is needed any more
+		candidate.arena.reset();
+
+		long long chunkHeapAllocationsBefore = chunkHeapAllocations;
+
+		RuinPolicy::ruin(completeSolution, numberOfStoriesToRemove, ruinCandidates, step, candidate.destroyedSolution, candidate.arena);
+		RepairPolicy::repair(candidate.destroyedSolution, candidate.repairedSolution, candidate.arena);
+
+		candidate.chunkHeapAllocations += chunkHeapAllocations - chunkHeapAllocationsBefore;
+
+		candidate.repairedSolutionValue = candidate.repairedSolution.roadmap.calculateValue();
+	}
+
+	// Restarts from the best roadmap on a path between two elites (see LNS::pathRelink), or failing that, on a path from an elite
+	// to a random roadmap at least the given number of stories away from the elite, which perturbs it by about that much
+	static Roadmap restartFromElites(const ElitePool &elites, int perturbation) {
+		int initiating = randomInt(0, elites.size() - 1);
+		Roadmap relinked;
+
+		if (elites.size() >= 2) {
+			int guiding = randomInt(0, elites.size() - 2);
+
+			if (guiding >= initiating)
+				++guiding;
+
+			if (LNS::pathRelink(elites.roadmaps[initiating], elites.roadmaps[guiding], 0, relinked))
+				return relinked;
+		}
+
+		Roadmap randomSolution = LNS::randomRoadmap(elites.roadmaps[initiating].instance);
+
+		if (LNS::pathRelink(elites.roadmaps[initiating], randomSolution, perturbation, relinked))
+			return relinked;
+
+		return randomSolution;
+	}
+
+	// See LNS::run
+	static Roadmap run(shared_ptr<const ProblemInstance> instance, LNSParameters parameters, Roadmap *warmStartSolution = NULL, LNSWorkspace *workspace = NULL) {
+		STATS_TIMER(TIMER_SOLVE);
+
+		auto t_start = chrono::steady_clock::now();
+		double previousElapsedTime = 0.0; // Time spent by the interrupted run this one resumes
+
+		// TODO
+		// - Dynamically set the number of elements to destroy and the Tabu tenure
+		//		- if the previous n iterations didn't improve, increase by 1
+		//		- cap the maximum
+
+		int problemSize = instance->numberOfStories * instance->numberOfSprints();
+
+		// Tabu parameters ///////////////////////////////////////////////////////
+		//////////////////////////////////////////////////////////////////////////
+
+		// Use the caller's buffers if it keeps any between runs
+		LNSWorkspace localWorkspace;
+		LNSWorkspace &buffers = workspace != NULL ? *workspace : localWorkspace;
+
+		// A continued search keeps its solutions, tabu list and iteration count from the last run
+		bool continuing = parameters.continueSearch && workspace != NULL;
+
+		if (!continuing)
+			STATS_ADD(COUNTER_STORIES, instance->numberOfStories);
+
+		int tabuTenure = problemSize * parameters.tabuTenureFraction;
+		TabuList &tabuList = buffers.tabuList;
+
+		if (!continuing)
+			tabuList.reset(instance->numberOfStories, instance->numberOfSprints(), tabuTenure, parameters.compactMode);
+
+		Roadmap &currentSolution = buffers.currentSolution;
+		Roadmap &bestSolution = buffers.bestSolution;
+
+		// Carry on from the last checkpoint of an interrupted run if asked to and there is one
+		Checkpoint checkpoint;
+		bool resuming = parameters.resume && !parameters.checkpointFileName.empty() && checkpoint.load(parameters.checkpointFileName);
+
+		if (resuming) {
+			if (checkpoint.instanceFingerprint != instance->fingerprint() || checkpoint.numberOfStories != instance->numberOfStories
+				|| checkpoint.numberOfSprints != instance->numberOfSprints() || checkpoint.compactTabuList != parameters.compactMode)
+				throw runtime_error("Checkpoint file " + parameters.checkpointFileName + " is of a different problem or mode");
+
+			currentSolution = Checkpoint::restoreRoadmap(instance, checkpoint.currentAssignments);
+			bestSolution = Checkpoint::restoreRoadmap(instance, checkpoint.bestAssignments);
+
+			tabuList.tabuIterations = checkpoint.tabuIterations;
+			tabuList.tabuSprints = checkpoint.tabuSprints;
+
+			previousElapsedTime = checkpoint.elapsedTime;
+		}
+		else if (!continuing) {
+			currentSolution = warmStartSolution != NULL ? *warmStartSolution : LNS::randomRoadmap(instance);
+			bestSolution = currentSolution;
+		}
+
+		// Storing the values saves recomputing the same thing at every iteration when comparing with new solutions
+		int currentSolutionValue = currentSolution.calculateValue();
+		int bestSolutionValue = bestSolution.calculateValue();
+
+		// Early termination /////////////////////////////////////////////////////
+		//////////////////////////////////////////////////////////////////////////
+
+		// Once the best solution reaches this value it is provably within the requested gap of the optimum
+		int upperBound = parameters.upperBound >= 0 ? parameters.upperBound : LNS::calculateUpperBound(*instance);
+		double targetValue = upperBound * (1.0 - parameters.optimalityGap);
+
+		if (bestSolutionValue >= targetValue)
+			return bestSolution;
+
+		// Simulated annealing parameters ////////////////////////////////////////
+		//////////////////////////////////////////////////////////////////////////
+
+		// Calibrated after the bound check as it's the most expensive part of easy instances
+		double startTemperature = resuming ? checkpoint.startTemperature
+			: parameters.startTemperature > 0 ? parameters.startTemperature : LNS::calculateInitialTemperature(instance, max(1.0, parameters.iterationBudget * problemSize), parameters.timeLimit / 10);
+		double temperature = resuming ? checkpoint.temperature : startTemperature;
+
+		//////////////////////////////////////////////////////////////////////////
+		//////////////////////////////////////////////////////////////////////////
+
+		int ruinMode = resuming ? checkpoint.ruinMode : continuing ? buffers.iterations % 2 : 0; // Counts the iterations, for ruin policies that take turns between operators
+		const vector<int> *ruinCandidates = parameters.ruinCandidates.get();
+		int numberOfStoriesToRemove = max(1.0, round(parameters.degreeOfDestruction * (ruinCandidates != NULL ? ruinCandidates->size() : instance->numberOfStories)));
+
+		int maxIterations = parameters.maxIterations > 0 ? parameters.maxIterations : 2 * problemSize * parameters.iterationBudget;
+		int firstIteration = resuming ? checkpoint.currentIteration : continuing ? buffers.iterations : 0;
+
+		if (continuing)
+			maxIterations += firstIteration;
+
+		int nonImprovingIterations = resuming ? checkpoint.nonImprovingIterations : 0;
+		int maxNonImprovingIterations = maxIterations * parameters.maxNonImprovingFraction;
+
+		int numberOfCandidates = max(1, parameters.candidatesPerIteration);
+		buffers.reserveCandidates(numberOfCandidates);
+
+		// Restarts without a warm start solution go back to one of the best roadmaps found so far, rather than all the way back to a random one
+		ElitePool elites(parameters.elitePoolSize, numberOfStoriesToRemove);
+
+		if (resuming) {
+			for (int i = 0; i < checkpoint.eliteValues.size(); ++i) {
+				auto eliteStart = checkpoint.eliteAssignments.begin() + (size_t)i * instance->numberOfStories;
+
+				elites.roadmaps.push_back(Checkpoint::restoreRoadmap(instance, vector<SprintPosition>(eliteStart, eliteStart + instance->numberOfStories)));
+				elites.values.push_back(checkpoint.eliteValues[i]);
+			}
+		}
+
+		// Each candidate takes the next turn of the ruin policy from its neighbour, so that an alternating ruin tries both operators every iteration
+		function<void(int)> buildCandidates = [&](int index) {
+			buildCandidate(currentSolution, numberOfStoriesToRemove, ruinCandidates, ruinMode + index, *buffers.candidates[index]);
+		};
+
+		// Candidates in the order they're offered for acceptance, best first
+		vector<int> candidateOrder(numberOfCandidates);
+
+		// The search's roadmaps: the current and best ones, a destroyed and a repaired one per candidate, the elites,
+		// and the few a restart builds on the way to a new current roadmap
+		int roadmapsKept = 2 + 2 * numberOfCandidates + parameters.elitePoolSize + 4;
+		int chunksPerRoadmap = (instance->numberOfStories + AssignmentArray::chunkSize - 1) / AssignmentArray::chunkSize;
+		ChunkReservation chunkReservation(instance->chunkPool, (size_t)roadmapsKept * chunksPerRoadmap);
+
+#ifndef NDEBUG
+		// Heap allocations made by the arenas and for assignment chunks once every candidate has tried each ruin mode and grown its arena to fit,
+		// after which they and the chunk pool should be big enough
+		long long warmedUpHeapAllocations = -1;
+#endif
+
+		// Checkpoints ///////////////////////////////////////////////////////////
+		//////////////////////////////////////////////////////////////////////////
+
+		// Restored last, as starting the candidates' threads draws seeds for them from the generator
+		// (the helper threads' own generators aren't saved, so only a search with one candidate per iteration resumes exactly)
+		if (resuming)
+			randomState = checkpoint.randomState;
+
+		auto t_lastCheckpoint = chrono::steady_clock::now();
+
+		auto saveCheckpoint = [&](int currentIteration) {
+			checkpoint.instanceFingerprint = instance->fingerprint();
+			checkpoint.numberOfStories = instance->numberOfStories;
+			checkpoint.numberOfSprints = instance->numberOfSprints();
+			checkpoint.currentIteration = currentIteration;
+			checkpoint.nonImprovingIterations = nonImprovingIterations;
+			checkpoint.ruinMode = ruinMode;
+			checkpoint.temperature = temperature;
+			checkpoint.startTemperature = startTemperature;
+			checkpoint.randomState = randomState;
+			checkpoint.currentAssignments = currentSolution.assignedSprints.toVector();
+			checkpoint.bestAssignments = bestSolution.assignedSprints.toVector();
+			checkpoint.compactTabuList = tabuList.compact;
+			checkpoint.tabuIterations = tabuList.tabuIterations;
+			checkpoint.tabuSprints = tabuList.tabuSprints;
+			checkpoint.eliteAssignments.clear();
+			checkpoint.eliteValues = elites.values;
+			checkpoint.elapsedTime = previousElapsedTime + chrono::duration<double>(chrono::steady_clock::now() - t_start).count();
+
+			for (const Roadmap &elite : elites.roadmaps) {
+				vector<SprintPosition> eliteAssignments = elite.assignedSprints.toVector();
+				checkpoint.eliteAssignments.insert(checkpoint.eliteAssignments.end(), eliteAssignments.begin(), eliteAssignments.end());
+			}
+
+			checkpoint.save(parameters.checkpointFileName);
+		};
+
+		// Saved straight away so that a run interrupted before its first interval is up still needn't calibrate again
+		if (!parameters.checkpointFileName.empty() && !resuming)
+			saveCheckpoint(firstIteration);
+
+		//////////////////////////////////////////////////////////////////////////
+		//////////////////////////////////////////////////////////////////////////
+
+		int currentIteration = firstIteration;
+
+		for (; currentIteration < maxIterations; ++currentIteration) {
+			//cout << currentSolutionValue << "," << bestSolutionValue << endl;
+
+			if (parameters.timeLimit > 0 && previousElapsedTime + chrono::duration<double>(chrono::steady_clock::now() - t_start).count() >= parameters.timeLimit)
+				break;
+
+			if (!parameters.checkpointFileName.empty()) {
+				auto t_now = chrono::steady_clock::now();
+
+				if (chrono::duration<double>(t_now - t_lastCheckpoint).count() >= parameters.checkpointInterval) {
+					saveCheckpoint(currentIteration);
+					t_lastCheckpoint = t_now;
+				}
+			}
+
+			STATS_COUNT(COUNTER_ITERATIONS);
+
+			if (nonImprovingIterations > maxNonImprovingIterations) {
+				STATS_COUNT(COUNTER_RESTARTS);
+
+				nonImprovingIterations = 0;
+				temperature = startTemperature; // temperature gets reset when a restart occurs
+
+				// The roadmaps the search settled on, rather than every step of the way there, which would fill the pool with
+				// the poor early solutions of the first descent
+				elites.offer(bestSolution, bestSolutionValue);
+
+				if (currentSolution.isFeasible())
+					elites.offer(currentSolution, currentSolutionValue);
+
+				if (warmStartSolution != NULL)
+					currentSolution = *warmStartSolution;
+				else if (elites.size() > 0)
+					currentSolution = restartFromElites(elites, numberOfStoriesToRemove);
+				else
+					currentSolution = LNS::randomRoadmap(instance);
+
+				currentSolutionValue = currentSolution.calculateValue();
+			}
+
+			if (numberOfCandidates == 1)
+				buildCandidate(currentSolution, numberOfStoriesToRemove, ruinCandidates, ruinMode, *buffers.candidates[0]);
+			else
+				buffers.candidateTasks.run(buildCandidates);
+
+			ruinMode = (ruinMode + 1) % 2; // alternating ruins go on with the other operator
+
+			for (int i = 0; i < numberOfCandidates; ++i)
+				candidateOrder[i] = i;
+
+#ifndef NDEBUG
+			long long heapAllocations = 0;
+
+			for (int i = 0; i < numberOfCandidates; ++i)
+				heapAllocations += buffers.candidates[i]->arena.heapAllocations + buffers.candidates[i]->chunkHeapAllocations;
+			// The steady-state loop should do all of its scratch work in the arenas and copy chunks into recycled blocks, without going back to the heap
+			assert(warmedUpHeapAllocations == -1 || heapAllocations == warmedUpHeapAllocations);
+
+			if (currentIteration == firstIteration + 2)
+				warmedUpHeapAllocations = heapAllocations;
+#endif
+
+			sort(candidateOrder.begin(), candidateOrder.end(), [&buffers](int a, int b) {
+				int aValue = buffers.candidates[a]->repairedSolutionValue;
+				int bValue = buffers.candidates[b]->repairedSolutionValue;
+				return aValue > bValue || (aValue == bValue && a < b);
+			});
+
+			// The best candidate that passes the acceptance criteria replaces the current solution
+			Candidate *acceptedCandidate = NULL;
+
+			for (int index : candidateOrder) {
+				Candidate &candidate = *buffers.candidates[index];
+
+				if (AcceptancePolicy::accept(candidate.repairedSolution, candidate.repairedSolutionValue, currentSolutionValue, temperature, currentIteration, &tabuList) && candidate.repairedSolution.roadmap.isFeasible()) {
+					acceptedCandidate = &candidate;
+					break;
+				}
+			}
+
+			if (acceptedCandidate != NULL) {
+				STATS_COUNT(COUNTER_ACCEPTED);
+
+				// Swapping rather than copying leaves the old current solution's memory to be reused by the next candidate
+				swap(currentSolution, acceptedCandidate->repairedSolution.roadmap);
+				currentSolutionValue = acceptedCandidate->repairedSolutionValue;
+
+				// Update the tabu list:
+				// - moves made in the destroyed solution represent moving story A out of sprint B
+				// - adding move 'story A -> sprint B' prevents undoing the move
+				for (Move move : acceptedCandidate->destroyedSolution.moves)
+					tabuList.add(move, currentIteration);
+
+				if (currentSolutionValue > bestSolutionValue && currentSolution.isFeasible()) {
+					{
+						STATS_TIMER(TIMER_BEST_COPY);
+						bestSolution = currentSolution;
+					}
+
+					bestSolutionValue = currentSolutionValue;
+
+					nonImprovingIterations = 0;
+
+					// The best solution can't be improved on enough to be worth carrying on
+					if (bestSolutionValue >= targetValue)
+						break;
+				}
+				else {
+					++nonImprovingIterations;
+				}
+			}
+			else {
+				STATS_COUNT(COUNTER_REJECTED);
+
+				++nonImprovingIterations;
+			}
+
+			temperature = CoolingPolicy::cool(temperature, startTemperature, currentIteration, maxIterations, parameters.coolingRate);
+		}
+
+		buffers.iterations = currentIteration;
+
+		// Take the cheap one-story improvements the ruin and repair missed
+		// (polishing every new best solution instead makes the search greedier, and it finds worse solutions for it)
+		if (parameters.useLocalSearch)
+			LNS::localSearch(bestSolution, problemSize);
+
+		return bestSolution;
+	}
+
+};
+
+typedef Roadmap (*LNSEngineFunction)(shared_ptr<const ProblemInstance> instance, LNSParameters parameters, Roadmap *warmStartSolution, LNSWorkspace *workspace);
+
+template <class RuinPolicy, class RepairPolicy, class AcceptancePolicy, class CoolingPolicy>
+void registerEngine(map<string, LNSEngineFunction> &engines) {
+	string name = string(RuinPolicy::name()) + "/" + RepairPolicy::name() + "/" + AcceptancePolicy::name() + "/" + CoolingPolicy::name();
+	engines[name] = &LNSEngine<RuinPolicy, RepairPolicy, AcceptancePolicy, CoolingPolicy>::run;
+}
+
+template <class RuinPolicy, class RepairPolicy, class AcceptancePolicy>
+void registerCoolingPolicies(map<string, LNSEngineFunction> &engines) {
+	registerEngine<RuinPolicy, RepairPolicy, AcceptancePolicy, GeometricCoolingPolicy>(engines);
+	registerEngine<RuinPolicy, RepairPolicy, AcceptancePolicy, LinearCoolingPolicy>(engines);
+}
+
+template <class RuinPolicy, class RepairPolicy>
+void registerAcceptancePolicies(map<string, LNSEngineFunction> &engines) {
+	registerCoolingPolicies<RuinPolicy, RepairPolicy, AnnealingAcceptancePolicy>(engines);
+	registerCoolingPolicies<RuinPolicy, RepairPolicy, ImprovingAcceptancePolicy>(engines);
+}
+
+template <class RuinPolicy>
+void registerRepairPolicies(map<string, LNSEngineFunction> &engines) {
+	registerAcceptancePolicies<RuinPolicy, KnapsackRepairPolicy>(engines);
+	registerAcceptancePolicies<RuinPolicy, GreedyRepairPolicy>(engines);
+}
+
+// Every prebuilt combination of policies, by "ruin/repair/acceptance/cooling" name (new policies need adding here)
+const map<string, LNSEngineFunction> &lnsEngines() {
+	static const map<string, LNSEngineFunction> engines = []() {
+		map<string, LNSEngineFunction> engines;
+
+		registerRepairPolicies<AlternatingRuinPolicy>(engines);
+		registerRepairPolicies<RadialRuinPolicy>(engines);
+		registerRepairPolicies<RandomRuinPolicy>(engines);
+
+		return engines;
+	}();
+
+	return engines;
+}
+
+Roadmap LNS::run(shared_ptr<const ProblemInstance> instance, LNSParameters parameters, Roadmap *warmStartSolution, LNSWorkspace *workspace) {
+	auto engine = lnsEngines().find(parameters.engineName());
+
+	if (engine == lnsEngines().end())
+		throw runtime_error("Unknown search configuration " + parameters.engineName());
+
+	return engine->second(instance, parameters, warmStartSolution, workspace);
+}
+
+vector<string> splitString(const string& s, char delimiter) {
+	vector<string> tokens;
+	string token;
+	istringstream tokenStream(s);
+
+	while (getline(tokenStream, token, delimiter)) {
+		tokens.push_back(token);
+	}
+
+	return tokens;
+}
+
+// Reads story data (starting with a header row) into Story objects and links up each story's dependees. Stories can have any IDs,
+// which are kept in storyId while the stories are numbered 0, 1, 2... in the order they're listed
+vector<Story> loadStories(istream &storiesFile) {
+	vector<Story> storyData;
+	unordered_map<int, int> storyNumbers; // Story ID -> story number
+	string line;
+
+	getline(storiesFile, line); // Skip column headers
+
+	while (getline(storiesFile, line)) {
+		vector<string> splitLine = splitString(line, ',');
+
+		if (splitLine.size() < 3)
+			continue;
+
+		int storyId = stoi(splitLine[0]);
+		int businessValue = stoi(splitLine[1]);
+		int storyPoints = stoi(splitLine[2]);
+		int storyNumber = storyData.size();
+
+		if (!storyNumbers.insert(make_pair(storyId, storyNumber)).second)
+			throw runtime_error("Story " + to_string(storyId) + " is listed more than once");
+
+		storyData.push_back(Story(storyNumber, businessValue, storyPoints));
+		storyData[storyNumber].storyId = storyId;
+
+		// Dependencies stay as IDs until every story has been read, as they can be further down the file
+		if (splitLine.size() == 4) {
+			string dependencyString = splitLine[3];
+
+			vector<string> splitDependencies = splitString(dependencyString, ';');
+
+			for (string dependeeString : splitDependencies) {
+				storyData[storyNumber].dependencies.push_back(stoi(dependeeString));
+			}
+		}
+	}
+
+	for (Story &story : storyData) {
+		for (int &dependency : story.dependencies) {
+			auto dependencyNumber = storyNumbers.find(dependency);
+
+			if (dependencyNumber == storyNumbers.end())
+				throw runtime_error("Story " + to_string(story.storyId) + " depends on unknown story " + to_string(dependency));
+
+			dependency = dependencyNumber->second;
+			storyData[dependency].dependees.push_back(story.storyNumber);
+		}
+	}
+
+	return storyData;
+}
+
+// Reads sprint data (starting with a header row) into Sprint objects, followed by the special product backlog sprint
+vector<Sprint> loadSprints(istream &sprintsFile) {
+	vector<Sprint> sprintData;
+	string line;
+
+	getline(sprintsFile, line); // Skip column headers
+
+	while (getline(sprintsFile, line)) {
+		vector<string> splitLine = splitString(line, ',');
+
+		if (splitLine.size() < 3)
+			continue;
+
+		int sprintNumber = stoi(splitLine[0]);
+		int sprintCapacity = stoi(splitLine[1]);
+		int sprintBonus = stoi(splitLine[2]);
+
+		sprintData.push_back(Sprint(sprintNumber, sprintCapacity, sprintBonus));
+	}
+
+	sprintData.push_back(Sprint(-1, 0, 0)); // A special sprint representing 'unassigned' (i.e. assigned to the product backlog)
+
+	return sprintData;
+}
+
+// Reads a file written by Roadmap::printAssignments into a map of story ID to sprint number
+map<int, int> loadAssignments(string assignmentsFileName) {
+	map<int, int> assignments;
+
+	string line;
+	ifstream assignmentsFile(assignmentsFileName);
+
+	if (!assignmentsFile.is_open()) {
+		cout << "Cannot open assignments file" << endl;
+		exit(0);
+	}
+
+	getline(assignmentsFile, line); // Skip column headers
+
+	while (getline(assignmentsFile, line)) {
+		vector<string> splitLine = splitString(line, ',');
+
+		if (splitLine.size() >= 2)
+			assignments[stoi(splitLine[0])] = stoi(splitLine[1]);
+	}
+
+	return assignments;
+}
+
+// Reads (parameter, value) rows, starting with a header row, as written by LNSParameters::toConfig into the parameters
+void loadConfig(string configFileName, LNSParameters &parameters) {
+	string line;
+	ifstream configFile(configFileName);
+
+	if (!configFile.is_open()) {
+		cout << "Cannot open config file" << endl;
+		exit(0);
+	}
+
+	getline(configFile, line); // Skip column headers
+
+	while (getline(configFile, line)) {
+		vector<string> splitLine = splitString(line, ',');
+
+		if (splitLine.size() < 2)
+			continue;
+
+		try {
+			parameters.set(splitLine[0], splitLine[1]);
+		}
+		catch (exception &e) {
+			cout << "Invalid config file " << configFileName << ": " << e.what() << endl;
+			exit(0);
+		}
+	}
+}
+
+// Results of earlier solves kept on disk, so that a problem that's solved again with the same settings is answered straight away and one with
+// the same stories, dependencies and sprints (but different values, story points or capacities) starts from the earlier roadmap. Processes
+// can share the directory: entries are written to a temporary file and renamed into place so nobody reads half an entry, and a reader
+// that loses an entry to another process's eviction just misses. Once the entries add up to more than the size limit, the least recently
+// used ones are deleted
+class SolutionCache {
+public:
+	filesystem::path directory;
+	long long sizeLimit; // In bytes
+
+	SolutionCache(string directory, long long sizeLimit) {
+		this->directory = directory;
+		this->sizeLimit = sizeLimit;
+
+		error_code error;
+		filesystem::create_directories(this->directory, error);
+	}
+
+	// Carries on an FNV-1a hash (see ProblemInstance::fingerprint) over the values
+	static unsigned long long addToHash(unsigned long long hash, const vector<int> &values) {
+		for (int value : values) {
+			hash ^= (unsigned int)value;
+			hash *= 1099511628211ULL;
+		}
+
+		return hash;
+	}
+
+	// Everything that decides the solution: the whole problem (with the story IDs, as entries are saved by ID) and the search settings
+	static unsigned long long exactKey(const ProblemInstance &instance, const LNSParameters &parameters) {
+		unsigned long long hash = addToHash(instance.fingerprint(), instance.graph->storyIds);
+		string settings = parameters.toConfig() + "compact," + to_string(parameters.compactMode) + "\nlocal_search," + to_string(parameters.useLocalSearch) + "\n";
+
+		for (char character : settings) {
+			hash ^= (unsigned char)character;
+			hash *= 1099511628211ULL;
+		}
+
+		return hash;
+	}
+
+	// The shape of the problem, without the story values and points or the sprint capacities and bonuses that a warm start can adapt to
+	static unsigned long long structureKey(const ProblemInstance &instance) {
+		unsigned long long hash = 14695981039346656037ULL;
+
+		hash = addToHash(hash, instance.graph->storyIds);
+		hash = addToHash(hash, instance.graph->dependencyOffsets);
+		hash = addToHash(hash, instance.graph->dependencyList);
+		hash = addToHash(hash, instance.sprintNumbers);
+
+		return hash;
+	}
+
+	static string entryName(char kind, unsigned long long key) {
+		ostringstream name;
+		name << kind << hex << setw(16) << setfill('0') << key << ".csv";
+		return name.str();
+	}
+
+	// Reads the assignments (story ID -> sprint number) of the solve with the exact key, or of the last solve of a problem with the
+	// same structure key. Returns false if there isn't one, or if it doesn't fit the instance
+	bool lookupExact(unsigned long long key, const ProblemInstance &instance, map<int, int> &assignments) {
+		return readEntry(entryName('e', key), key, instance, assignments);
+	}
+
+	bool lookupStructure(unsigned long long key, const ProblemInstance &instance, map<int, int> &assignments) {
+		return readEntry(entryName('s', key), key, instance, assignments);
+	}
+
+	// Saves the roadmap under both keys, then makes room for it
+	void store(Roadmap &roadmap, unsigned long long exactKey, unsigned long long structureKey) {
+		string assignments = roadmap.printAssignments();
+
+		writeEntry(entryName('e', exactKey), exactKey, assignments);
+		writeEntry(entryName('s', structureKey), structureKey, assignments);
+
+		evict();
+	}
+
+	// Entries start with a line of their key, to tell a complete entry of this key from anything else by that name. Keys can collide
+	// and files can be damaged, so the body is only used if every line is a story of the instance, given once, in one of its sprints
+	bool readEntry(string name, unsigned long long key, const ProblemInstance &instance, map<int, int> &assignments) {
+		filesystem::path path = directory / name;
+		ifstream entryFile(path);
+		string line;
+
+		if (!entryFile.is_open() || !getline(entryFile, line) || line != "cache_key," + to_string(key))
+			return false;
+
+		if (!getline(entryFile, line) || line != "story_number,sprint_number")
+			return false;
+
+		map<int, int> entryAssignments;
+
+		while (getline(entryFile, line)) {
+			vector<string> splitLine = splitString(line, ',');
+			int storyId, sprintNumber;
+			size_t storyIdLength, sprintNumberLength;
+
+			if (splitLine.size() != 2)
+				return false;
+
+			try {
+				storyId = stoi(splitLine[0], &storyIdLength);
+				sprintNumber = stoi(splitLine[1], &sprintNumberLength);
+			}
+			catch (exception &) {
+				return false;
+			}
+
+			if (storyIdLength != splitLine[0].size() || sprintNumberLength != splitLine[1].size())
+				return false;
+
+			if (instance.storyNumberOf(storyId) == -1 || instance.sprintPosition(sprintNumber) == -1 || entryAssignments.count(storyId))
+				return false;
+
+			entryAssignments[storyId] = sprintNumber;
+		}
+
+		assignments = entryAssignments;
+
+		// Using an entry makes it the most recently used
+		error_code error;
+		filesystem::last_write_time(path, filesystem::file_time_type::clock::now(), error);
+
+		return true;
+	}
+
+	void writeEntry(string name, unsigned long long key, const string &assignments) {
+		filesystem::path path = directory / name;
+		filesystem::path temporaryPath = directory / (name + ".tmp" + uniqueSuffix());
+		error_code error;
+
+		{
+			ofstream entryFile(temporaryPath);
+			entryFile << "cache_key," << key << "\n" << assignments;
+
+			if (!entryFile) {
+				entryFile.close();
+				filesystem::remove(temporaryPath, error);
+				return;
+			}
+		}
+
+		filesystem::rename(temporaryPath, path, error);
+
+		if (error)
+			filesystem::remove(temporaryPath, error);
+	}
+
+	// Different in every process, thread and write, so concurrent writers never share a temporary file (unlike anything drawn from
+	// the random number generator, which other processes may have seeded the same way)
+	static string uniqueSuffix() {
+		static atomic<unsigned long long> writes(0);
+
+#ifdef _WIN32
+		unsigned long long processId = GetCurrentProcessId();
+#else
+		unsigned long long processId = getpid();
+#endif
+
+		return to_string(processId) + "-" + to_string(hash<thread::id>()(this_thread::get_id())) + "-" + to_string(++writes);
+	}
+
+	// Deletes the least recently used entries until the rest fit in the size limit, along with temporary files left behind by
+	// processes that died while writing an entry. Anything another process deletes first is skipped
+	void evict() {
+		vector<tuple<filesystem::file_time_type, long long, filesystem::path>> entries;
+		long long totalSize = 0;
+		auto staleTime = filesystem::file_time_type::clock::now() - chrono::hours(1);
+		error_code error;
+
+		for (filesystem::directory_iterator file(directory, error), end; !error && file != end; file.increment(error)) {
+			error_code fileError;
+			filesystem::file_time_type writeTime = file->last_write_time(fileError);
+			long long size = file->file_size(fileError);
+
+			if (fileError || !file->is_regular_file(fileError))
+				continue;
+
+			if (file->path().extension() != ".csv") {
+				if (file->path().filename().string().find(".csv.tmp") != string::npos && writeTime < staleTime)
+					filesystem::remove(file->path(), fileError);
+
+				continue;
+			}
+
+			entries.push_back(make_tuple(writeTime, size, file->path()));
+			totalSize += size;
+		}
+
+		sort(entries.begin(), entries.end());
+
+		// An entry that's already gone has made room all the same
+		for (int i = 0; i < entries.size() && totalSize > sizeLimit; ++i) {
+			filesystem::remove(get<2>(entries[i]), error);
+			totalSize -= get<1>(entries[i]);
+		}
+	}
+};
+
+// The most memory the process has had resident at once, in bytes (or -1 if the platform can't say)
+long long peakMemoryUsage() {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return counters.PeakWorkingSetSize;
+#else
+	ifstream statusFile("/proc/self/status");
+	string line;
+
+	while (getline(statusFile, line)) {
+		if (line.compare(0, 6, "VmHWM:") == 0)
+			return stoll(line.substr(6)) * 1024;
+	}
+#endif
+
+	return -1;
+}
+
+// A roadmap to solve, received by the solver service
+class SolveRequest {
+public:
+	string requestId;
+	shared_ptr<const ProblemInstance> instance;
+	LNSParameters parameters;
+	chrono::high_resolution_clock::time_point receivedTime;
+
+	// Sends the response back to whoever made the request
+	function<void(string)> respond;
+
+	SolveRequest() {};
+};
+
+// Long-running solver that queues requests onto a pool of workers
+// Each worker keeps its own LNS workspace, so solutions and tabu lists are reused between requests
+class SolverService {
+public:
+	mutex queueMutex;
+	condition_variable queueChanged;
+	queue<SolveRequest> requests;
+	vector<thread> workers;
+	bool stopping;
+
+	SolverService(int numberOfWorkers) {
+		this->stopping = false;
+
+		for (int i = 0; i < numberOfWorkers; ++i)
+			workers.push_back(thread(&SolverService::work, this, i));
+	}
+
+	void submit(SolveRequest request) {
+		{
+			lock_guard<mutex> lock(queueMutex);
+			requests.push(request);
+		}
+
+		queueChanged.notify_one();
+	}
+
+	// Finishes all the queued requests and stops the workers
+	void shutdown() {
+		{
+			lock_guard<mutex> lock(queueMutex);
+			stopping = true;
+		}
+
+		queueChanged.notify_all();
+
+		for (thread &worker : workers)
+			worker.join();
+
+		workers.clear();
+	}
+
+	void work(int workerNumber) {
+		seedRandom(time(NULL) ^ ((unsigned long long)(workerNumber + 1) << 32));
+
+		LNSWorkspace workspace;
+
+		while (true) {
+			SolveRequest request;
+
+			{
+				unique_lock<mutex> lock(queueMutex);
+				queueChanged.wait(lock, [this]() { return stopping || !requests.empty(); });
+
+				// Only stop once the queue has been drained
+				if (requests.empty())
+					return;
+
+				request = requests.front();
+				requests.pop();
+			}
+
+			auto t_solveStart = chrono::high_resolution_clock::now();
+
+			// A request the solve fails on (e.g. one too big to allocate) gets an error rather than taking the whole service down
+			try {
+				// Worked out here rather than by the search so that the response can give it without working it out again
+				request.parameters.upperBound = LNS::calculateUpperBound(*request.instance);
+
+				Roadmap bestSolution = LNS::assignBacklogStories(LNS::run(request.instance, request.parameters, NULL, &workspace));
+
+				auto t_solveEnd = chrono::high_resolution_clock::now();
+
+				ostringstream response;
+				response << "RESULT " << request.requestId
+					<< " " << bestSolution.calculateValue()
+					<< " " << request.parameters.upperBound
+					<< " " << chrono::duration<double, std::milli>(t_solveStart - request.receivedTime).count()
+					<< " " << chrono::duration<double, std::milli>(t_solveEnd - t_solveStart).count() << "\n"
+					<< bestSolution.printAssignments()
+					<< "END\n";
+
+				request.respond(response.str());
+			}
+			catch (exception &e) {
+				request.respond("ERROR " + request.requestId + " " + e.what() + "\nEND\n");
+			}
+		}
+	}
+};
+
+// Reads requests from the stream and submits them to the service until the stream ends. Each request is framed as:
+//   SOLVE <request id> <number of story rows> <number of sprint rows> [<optimality gap> [<iteration budget>]]
+// followed by the story rows and then the sprint rows, in the same format as the data files but without headers.
+// The response is framed as:
+//   RESULT <request id> <value> <upper bound> <queued ms> <solve ms>
+// followed by the assignments (as written by --output) and a line saying END
+void serveRequests(istream &input, SolverService &service, function<void(string)> respond) {
+	string line;
+
+	while (getline(input, line)) {
+		auto t_received = chrono::high_resolution_clock::now();
+
+		vector<string> header = splitString(line, ' ');
+
+		if (header.empty() || (header.size() == 1 && header[0].find_first_not_of(" \r") == string::npos))
+			continue;
+
+		if (header[0] != "SOLVE" || header.size() < 4) {
+			respond("ERROR - Expected: SOLVE <request id> <number of story rows> <number of sprint rows>\nEND\n");
+			continue;
+		}
+
+		SolveRequest request;
+		request.requestId = header[1];
+		request.receivedTime = t_received;
+		request.respond = respond;
+
+		try {
+			// Read the whole frame before parsing it so that a bad row doesn't lose track of where the next request starts
+			stringstream storyRows, sprintRows;
+			storyRows << "header\n";
+			sprintRows << "header\n";
+
+			int numberOfStoryRows = stoi(header[2]);
+			int numberOfSprintRows = stoi(header[3]);
+
+			for (int i = 0; i < numberOfStoryRows && getline(input, line); ++i)
+				storyRows << line << "\n";
+
+			for (int i = 0; i < numberOfSprintRows && getline(input, line); ++i)
+				sprintRows << line << "\n";
+
+			if (header.size() > 4)
+				request.parameters.optimalityGap = stod(header[4]);
+
+			if (header.size() > 5)
+				request.parameters.iterationBudget = stod(header[5]);
+
+			request.parameters.validate();
+
+			request.instance = make_shared<ProblemInstance>(loadStories(storyRows), loadSprints(sprintRows));
+		}
+		catch (exception &e) {
+			respond("ERROR " + request.requestId + " " + e.what() + "\nEND\n");
+			continue;
+		}
+
+		service.submit(request);
+	}
+}
+
+// One line of a batch manifest and the outcome of solving it
+class BatchInstance {
+public:
+	string storyDataFileName, sprintDataFileName, outputFileName;
+
+	// Total size of the data files, used to hand out the biggest instances first
+	long long estimatedSize;
+
+	// Filled in by the I/O thread, possibly while earlier instances are still being solved
+	shared_future<shared_ptr<const ProblemInstance>> loadedInstance;
+
+	int numberOfStories, numberOfSprints, value, upperBound;
+	double loadWaitTime, solveTime;
+	string error;
+
+	BatchInstance() {
+		this->estimatedSize = 0;
+		this->numberOfStories = 0;
+		this->numberOfSprints = 0;
+		this->value = 0;
+		this->upperBound = 0;
+		this->loadWaitTime = 0;
+		this->solveTime = 0;
+	};
+};
+
+// Returns the size of a file in bytes, or 0 if it can't be opened
+long long fileSize(string fileName) {
+	ifstream file(fileName, ios::binary | ios::ate);
+	return file.is_open() ? (long long)file.tellg() : 0;
+}
+
+// Work-stealing scheduler: each worker has its own queue of instances, takes from the front of it and,
+// once it runs dry, steals from the back of the other workers' queues
+class WorkStealingQueues {
+public:
+	vector<deque<int>> queues;
+	vector<unique_ptr<mutex>> queueMutexes;
+
+	WorkStealingQueues(int numberOfWorkers) {
+		queues.resize(numberOfWorkers);
+
+		for (int i = 0; i < numberOfWorkers; ++i)
+			queueMutexes.push_back(unique_ptr<mutex>(new mutex()));
+	}
+
+	void push(int worker, int task) {
+		lock_guard<mutex> lock(*queueMutexes[worker]);
+		queues[worker].push_back(task);
+	}
+
+	// Returns the next task for the worker, or -1 once every queue is empty
+	int next(int worker) {
+		{
+			lock_guard<mutex> lock(*queueMutexes[worker]);
+
+			if (!queues[worker].empty()) {
+				int task = queues[worker].front();
+				queues[worker].pop_front();
+				return task;
+			}
+		}
+
+		for (int offset = 1; offset < queues.size(); ++offset) {
+			int victim = (worker + offset) % queues.size();
+			lock_guard<mutex> lock(*queueMutexes[victim]);
+
+			if (!queues[victim].empty()) {
+				int task = queues[victim].back();
+				queues[victim].pop_back();
+				return task;
+			}
+		}
+
+		return -1;
+	}
+};
+
+// Solves every (story data file, sprint data file, output file) line of the manifest in parallel, writing each
+// solution's assignments to its output file and a summary table to stdout
+void runBatch(string manifestFileName, LNSParameters parameters, int numberOfWorkers) {
+	ifstream manifestFile(manifestFileName);
+
+	if (!manifestFile.is_open()) {
+		cout << "Cannot open batch manifest file" << endl;
+		exit(0);
+	}
+
+	vector<BatchInstance> instances;
+	string line;
+
+	getline(manifestFile, line); // Skip column headers
+
+	while (getline(manifestFile, line)) {
+		vector<string> splitLine = splitString(line, ',');
+
+		if (splitLine.size() < 3)
+			continue;
+
+		BatchInstance instance;
+		instance.storyDataFileName = splitLine[0];
+		instance.sprintDataFileName = splitLine[1];
+		instance.outputFileName = splitLine[2];
+		instance.estimatedSize = fileSize(instance.storyDataFileName) + fileSize(instance.sprintDataFileName);
+		instances.push_back(instance);
+	}
+
+	// Largest instances first, dealt round-robin so that every worker starts with a similar share of the work
+	vector<int> order;
+
+	for (int i = 0; i < instances.size(); ++i)
+		order.push_back(i);
+
+	sort(order.begin(), order.end(), [&instances](int a, int b) { return instances[a].estimatedSize > instances[b].estimatedSize; });
+
+	WorkStealingQueues scheduler(numberOfWorkers);
+	vector<promise<shared_ptr<const ProblemInstance>>> loadedInstances(instances.size());
+
+	for (int i = 0; i < order.size(); ++i) {
+		instances[order[i]].loadedInstance = loadedInstances[order[i]].get_future().share();
+		scheduler.push(i % numberOfWorkers, order[i]);
+	}
+
+	auto t_batchStart = chrono::high_resolution_clock::now();
+
+	// The I/O thread loads instances in roughly the order the workers will pick them up, overlapping loading with solving
+	thread loader([&instances, &order, &loadedInstances]() {
+		for (int i : order) {
+			try {
+				ifstream storiesFile(instances[i].storyDataFileName);
+				ifstream sprintsFile(instances[i].sprintDataFileName);
+
+				if (!storiesFile.is_open())
+					throw runtime_error("Cannot open story data file");
+
+				if (!sprintsFile.is_open())
+					throw runtime_error("Cannot open sprint data file");
+
+				loadedInstances[i].set_value(make_shared<ProblemInstance>(loadStories(storiesFile), loadSprints(sprintsFile)));
+			}
+			catch (exception &) {
+				loadedInstances[i].set_exception(current_exception());
+			}
+		}
+	});
+
+	vector<thread> workers;
+
+	for (int worker = 0; worker < numberOfWorkers; ++worker) {
+		workers.push_back(thread([&instances, &scheduler, parameters, worker]() {
+			seedRandom(time(NULL) ^ ((unsigned long long)(worker + 1) << 32));
+
+			LNSWorkspace workspace;
+
+			for (int task = scheduler.next(worker); task != -1; task = scheduler.next(worker)) {
+				BatchInstance &instance = instances[task];
+
+				auto t_waitStart = chrono::high_resolution_clock::now();
+
+				try {
+					shared_ptr<const ProblemInstance> loadedInstance = instance.loadedInstance.get();
+
+					auto t_solveStart = chrono::high_resolution_clock::now();
+
+					Roadmap bestSolution = LNS::assignBacklogStories(LNS::run(loadedInstance, parameters, NULL, &workspace));
+
+					auto t_solveEnd = chrono::high_resolution_clock::now();
+
+					instance.numberOfStories = loadedInstance->numberOfStories;
+					instance.numberOfSprints = loadedInstance->numberOfSprints() - 1;
+					instance.value = bestSolution.calculateValue();
+					instance.upperBound = LNS::calculateUpperBound(*loadedInstance);
+					instance.loadWaitTime = chrono::duration<double, std::milli>(t_solveStart - t_waitStart).count();
+					instance.solveTime = chrono::duration<double, std::milli>(t_solveEnd - t_solveStart).count();
+
+					ofstream outputFile(instance.outputFileName);
+
+					if (!outputFile.is_open())
+						throw runtime_error("Cannot open output file");
+
+					outputFile << bestSolution.printAssignments();
+				}
+				catch (exception &e) {
+					instance.error = e.what();
+				}
+			}
+		}));
+	}
+
+	loader.join();
+
+	for (thread &worker : workers)
+		worker.join();
+
+	auto t_batchEnd = chrono::high_resolution_clock::now();
+
+	// Summary table /////////////////////////////////////////////////////////
+	//////////////////////////////////////////////////////////////////////////
+
+	cout << left << setw(40) << "Stories file" << right
+		<< setw(10) << "Stories" << setw(10) << "Sprints" << setw(12) << "Value" << setw(12) << "Bound"
+		<< setw(10) << "Gap %" << setw(12) << "Load ms" << setw(12) << "Solve ms" << endl;
+
+	for (BatchInstance instance : instances) {
+		cout << left << setw(40) << instance.storyDataFileName << right;
+
+		if (!instance.error.empty()) {
+			cout << "  failed: " << instance.error << endl;
+			continue;
+		}
+
+		double optimalityGap = instance.upperBound > 0 ? 100.0 * (instance.upperBound - instance.value) / instance.upperBound : 0.0;
+
+		cout << setw(10) << instance.numberOfStories << setw(10) << instance.numberOfSprints
+			<< setw(12) << instance.value << setw(12) << instance.upperBound
+			<< fixed << setprecision(2) << setw(10) << optimalityGap
+			<< setw(12) << instance.loadWaitTime << setw(12) << instance.solveTime << endl;
+	}
+
+	cout << endl << "Solved " << instances.size() << " instances with " << numberOfWorkers << " workers in "
+		<< chrono::duration<double, std::milli>(t_batchEnd - t_batchStart).count() << " ms" << endl;
+
+	if (statsEnabled)
+		printStats();
+}
+
+// One change to the base problem in a what-if scenario, e.g. sprint 3's capacity becoming 24
+class ScenarioOverride {
+public:
+	string target, field; // "story" and "value", or "sprint" and "capacity" or "bonus"
+	int number, value;
+
+	ScenarioOverride() {};
+
+	ScenarioOverride(string target, int number, string field, int value) {
+		this->target = target;
+		this->number = number;
+		this->field = field;
+		this->value = value;
+	}
+};
+
+class Scenario {
+public:
+	string name;
+	vector<ScenarioOverride> overrides;
+
+	int value, upperBound, movedStories;
+	double solveTime;
+	string error;
+
+	Scenario() {
+		this->value = 0;
+		this->upperBound = 0;
+		this->movedStories = 0;
+		this->solveTime = 0;
+	};
+};
+
+// Reads (scenario, target, number, field, value) rows, starting with a header row, into scenarios in the order they're first named
+vector<Scenario> loadScenarios(istream &scenariosFile) {
+	vector<Scenario> scenarios;
+	map<string, int> scenariosByName;
+	string line;
+
+	getline(scenariosFile, line); // Skip column headers
+
+	while (getline(scenariosFile, line)) {
+		vector<string> splitLine = splitString(line, ',');
+
+		if (splitLine.size() < 5)
+			continue;
+
+		if (!scenariosByName.count(splitLine[0])) {
+			scenariosByName[splitLine[0]] = scenarios.size();
+			scenarios.push_back(Scenario());
+			scenarios.back().name = splitLine[0];
+		}
+
+		scenarios[scenariosByName[splitLine[0]]].overrides.push_back(ScenarioOverride(splitLine[1], stoi(splitLine[2]), splitLine[3], stoi(splitLine[4])));
+	}
+
+	return scenarios;
+}
+
+// Solves the base problem once, then every what-if scenario of it in parallel, each a copy of the base instance with its overrides
+// applied (so nothing is parsed twice) that warm-starts from the base roadmap with the base's temperature. Prints a table comparing
+// the scenarios with the base
+void runScenarios(shared_ptr<const ProblemInstance> baseInstance, string scenariosFileName, LNSParameters parameters, double scenarioBudget, int numberOfWorkers) {
+	ifstream scenariosFile(scenariosFileName);
+
+	if (!scenariosFile.is_open()) {
+		cout << "Cannot open scenarios file" << endl;
+		exit(0);
+	}
+
+	vector<Scenario> scenarios;
+
+	try {
+		scenarios = loadScenarios(scenariosFile);
+	}
+	catch (exception &) {
+		cout << "Scenarios file isn't in the format: scenario,story|sprint,number,value|capacity|bonus,new value" << endl;
+		exit(0);
+	}
+
+	auto t_baseStart = chrono::high_resolution_clock::now();
+
+	// Calibrating the temperature takes many random roadmaps, so it's done once and shared with every scenario
+	if (parameters.startTemperature <= 0) {
+		int problemSize = baseInstance->numberOfStories * baseInstance->numberOfSprints();
+		parameters.startTemperature = max(1.0, LNS::calculateInitialTemperature(baseInstance, max(1.0, parameters.iterationBudget * problemSize)));
+	}
+
+	Roadmap baseSolution = LNS::assignBacklogStories(LNS::run(baseInstance, parameters));
+	int baseValue = baseSolution.calculateValue();
+
+	auto t_baseEnd = chrono::high_resolution_clock::now();
+
+	// The sprint number each story ended up in, which is how a roadmap is carried over to an instance with different data
+	map<int, int> baseAssignments;
+
+	for (int storyNumber = 0; storyNumber < baseInstance->numberOfStories; ++storyNumber) {
+		if (baseSolution.isAssigned(storyNumber))
+			baseAssignments[baseInstance->graph->storyIds[storyNumber]] = baseInstance->sprintNumbers[baseSolution.assignedSprints[storyNumber]];
+	}
+
+	LNSParameters scenarioParameters = parameters;
+	scenarioParameters.iterationBudget = scenarioBudget;
+
+	WorkStealingQueues scheduler(numberOfWorkers);
+
+	for (int i = 0; i < scenarios.size(); ++i)
+		scheduler.push(i % numberOfWorkers, i);
+
+	vector<thread> workers;
+
+	for (int worker = 0; worker < numberOfWorkers; ++worker) {
+		workers.push_back(thread([&scenarios, &scheduler, &baseInstance, &baseAssignments, scenarioParameters, worker]() {
+			seedRandom(time(NULL) ^ ((unsigned long long)(worker + 1) << 32));
+
+			LNSWorkspace workspace;
+
+			for (int task = scheduler.next(worker); task != -1; task = scheduler.next(worker)) {
+				Scenario &scenario = scenarios[task];
+
+				auto t_solveStart = chrono::high_resolution_clock::now();
+
+				try {
+					// Only the values, capacities and bonuses are copied to be changed, the story graph is shared with the base instance
+					shared_ptr<ProblemInstance> instance = make_shared<ProblemInstance>(*baseInstance);
+
+					for (ScenarioOverride change : scenario.overrides)
+						instance->applyOverride(change.target, change.number, change.field, change.value);
+
+					Roadmap warmStartSolution = LNS::warmStartRoadmap(instance, baseAssignments);
+					Roadmap bestSolution = LNS::assignBacklogStories(LNS::run(instance, scenarioParameters, &warmStartSolution, &workspace));
+
+					scenario.value = bestSolution.calculateValue();
+					scenario.upperBound = LNS::calculateUpperBound(*instance);
+
+					for (int storyNumber = 0; storyNumber < instance->numberOfStories; ++storyNumber) {
+						auto baseAssignment = baseAssignments.find(instance->graph->storyIds[storyNumber]);
+						int baseSprintNumber = baseAssignment != baseAssignments.end() ? baseAssignment->second : -1;
+						int sprintNumber = bestSolution.isAssigned(storyNumber) ? instance->sprintNumbers[bestSolution.assignedSprints[storyNumber]] : -1;
+
+						if (sprintNumber != baseSprintNumber)
+							++scenario.movedStories;
+					}
+				}
+				catch (exception &e) {
+					scenario.error = e.what();
+				}
+
+				scenario.solveTime = chrono::duration<double, std::milli>(chrono::high_resolution_clock::now() - t_solveStart).count();
+			}
+		}));
+	}
+
+	for (thread &worker : workers)
+		worker.join();
+
+	auto t_scenariosEnd = chrono::high_resolution_clock::now();
+
+	// Comparison table //////////////////////////////////////////////////////
+	//////////////////////////////////////////////////////////////////////////
+
+	int baseUpperBound = LNS::calculateUpperBound(*baseInstance);
+
+	cout << left << setw(30) << "Scenario" << right
+		<< setw(10) << "Changes" << setw(12) << "Value" << setw(12) << "Change" << setw(12) << "Bound"
+		<< setw(10) << "Gap %" << setw(10) << "Moved" << setw(12) << "Solve ms" << endl;
+
+	auto printRow = [](string name, int changes, int value, int valueChange, int upperBound, int movedStories, double solveTime) {
+		double optimalityGap = upperBound > 0 ? 100.0 * (upperBound - value) / upperBound : 0.0;
+
+		cout << left << setw(30) << name << right
+			<< setw(10) << changes << setw(12) << value << setw(12) << showpos << valueChange << noshowpos << setw(12) << upperBound
+			<< fixed << setprecision(2) << setw(10) << optimalityGap
+			<< setw(10) << movedStories << setw(12) << solveTime << endl;
+	};
+
+	printRow("(base)", 0, baseValue, 0, baseUpperBound, 0, chrono::duration<double, std::milli>(t_baseEnd - t_baseStart).count());
+
+	for (Scenario scenario : scenarios) {
+		if (!scenario.error.empty()) {
+			cout << left << setw(30) << scenario.name << right << "  failed: " << scenario.error << endl;
+			continue;
+		}
+
+		printRow(scenario.name, scenario.overrides.size(), scenario.value, scenario.value - baseValue, scenario.upperBound, scenario.movedStories, scenario.solveTime);
+	}
+
+	cout << endl << "Solved the base and " << scenarios.size() << " scenarios with " << numberOfWorkers << " workers in "
+		<< chrono::duration<double, std::milli>(t_scenariosEnd - t_baseStart).count() << " ms" << endl;
+
+	if (statsEnabled)
+		printStats();
+}
+
+// A configuration of the search racing in runTuning, with its score (value as a fraction of the upper bound) on each instance raced so far
+class TuningConfiguration {
+public:
+	LNSParameters parameters;
+	vector<double> scores;
+	bool eliminated;
+
+	TuningConfiguration(LNSParameters parameters) {
+		this->parameters = parameters;
+		this->eliminated = false;
+	}
+
+	double meanScore() const {
+		double total = 0;
+
+		for (double score : scores)
+			total += score;
+
+		return scores.empty() ? 0.0 : total / scores.size();
+	}
+};
+
+// Critical value of Student's t distribution for a one-sided test at the 5% level
+double studentTCritical(int degreesOfFreedom) {
+	static const double criticalValues[] = { 6.314, 2.920, 2.353, 2.132, 2.015, 1.943, 1.895, 1.860, 1.833, 1.812,
+		1.796, 1.782, 1.771, 1.761, 1.753, 1.746, 1.740, 1.734, 1.729, 1.725, 1.721, 1.717, 1.714, 1.711, 1.708, 1.706, 1.703, 1.701, 1.699, 1.697 };
+
+	return degreesOfFreedom <= 30 ? criticalValues[max(1, degreesOfFreedom) - 1] : 1.645;
+}
+
+// True if the challenger scores worse than the leader on the same instances by more than chance would explain (paired t-test)
+bool significantlyWorse(const TuningConfiguration &challenger, const TuningConfiguration &leader) {
+	int n = challenger.scores.size();
+	double meanDifference = 0, variance = 0;
+
+	for (int i = 0; i < n; ++i)
+		meanDifference += (leader.scores[i] - challenger.scores[i]) / n;
+
+	for (int i = 0; i < n; ++i) {
+		double deviation = leader.scores[i] - challenger.scores[i] - meanDifference;
+		variance += deviation * deviation / (n - 1);
+	}
+
+	// Consistently behind by the same amount on every instance
+	if (variance == 0)
+		return meanDifference > 0;
+
+	return meanDifference / sqrt(variance / n) > studentTCritical(n - 1);
+}
+
+// A random variation of the given parameters, drawing each tuned setting from the range it's plausible in
+LNSParameters randomConfiguration(LNSParameters parameters) {
+	static const char *ruinPolicies[] = { "alternating", "radial", "random" };
+	static const char *repairPolicies[] = { "knapsack", "greedy" };
+	static const char *acceptancePolicies[] = { "annealing", "improving" };
+	static const char *coolingPolicies[] = { "geometric", "linear" };
+
+	// Rates close to 1 matter most, so the gap to 1 is drawn on a log scale (0.9 to 0.99999)
+	parameters.coolingRate = 1.0 - pow(10.0, randomDouble(-5.0, -1.0));
+	parameters.degreeOfDestruction = randomDouble(0.02, 0.4);
+	parameters.tabuTenureFraction = pow(10.0, randomDouble(-3.0, -0.7));
+	parameters.maxNonImprovingFraction = randomDouble(0.05, 1.0);
+	parameters.iterationBudget = pow(10.0, randomDouble(-1.0, 1.0));
+
+	parameters.ruinPolicy = ruinPolicies[randomInt(0, 2)];
+	parameters.repairPolicy = repairPolicies[randomInt(0, 1)];
+	parameters.acceptancePolicy = acceptancePolicies[randomInt(0, 1)];
+	parameters.coolingPolicy = coolingPolicies[randomInt(0, 1)];
+
+	return parameters;
+}
+
+// Races the given parameters against random variations of them over the (story data file, sprint data file) instances of the manifest,
+// each search getting the parameters' time limit. Every configuration still in the race solves the next instance in parallel, and once
+// there are enough results to compare, those significantly worse than the best so far drop out. The best configuration left at the end
+// is written to the config file (see loadConfig)
+void runTuning(string manifestFileName, LNSParameters parameters, int numberOfConfigurations, string configFileName, int numberOfWorkers) {
+	// Instances to race on before dropping any configuration, so that one unlucky instance doesn't decide the race
+	const int firstTest = 5;
+
+	ifstream manifestFile(manifestFileName);
+
+	if (!manifestFile.is_open()) {
+		cout << "Cannot open tuning manifest file" << endl;
+		exit(0);
+	}
+
+	vector<string> instanceNames;
+	vector<shared_ptr<const ProblemInstance>> instances;
+	string line;
+
+	getline(manifestFile, line); // Skip column headers
+
+	while (getline(manifestFile, line)) {
+		vector<string> splitLine = splitString(line, ',');
+
+		if (splitLine.size() < 2)
+			continue;
+
+		try {
+			ifstream storiesFile(splitLine[0]);
+			ifstream sprintsFile(splitLine[1]);
+
+			if (!storiesFile.is_open())
+				throw runtime_error("Cannot open story data file");
+
+			if (!sprintsFile.is_open())
+				throw runtime_error("Cannot open sprint data file");
+
+			instances.push_back(make_shared<ProblemInstance>(loadStories(storiesFile), loadSprints(sprintsFile)));
+			instanceNames.push_back(splitLine[0]);
+		}
+		catch (exception &e) {
+			cout << "Skipping " << splitLine[0] << ": " << e.what() << endl;
+		}
+	}
+
+	if (instances.empty()) {
+		cout << "No instances to tune on" << endl;
+		exit(0);
+	}
+
+	// Raced in a random order, so that the instances the race is decided on aren't the same ones every time
+	vector<int> order;
+
+	for (int i = 0; i < instances.size(); ++i)
+		order.push_back(i);
+
+	randomShuffle(order);
+
+	// The given parameters race too, so the tuned configuration is never worse than what's being used already
+	vector<TuningConfiguration> configurations;
+	configurations.push_back(TuningConfiguration(parameters));
+
+	for (int i = 1; i < numberOfConfigurations; ++i)
+		configurations.push_back(TuningConfiguration(randomConfiguration(parameters)));
+
+	auto t_tuningStart = chrono::high_resolution_clock::now();
+
+	for (int round = 0; round < order.size(); ++round) {
+		shared_ptr<const ProblemInstance> instance = instances[order[round]];
+		int upperBound = LNS::calculateUpperBound(*instance);
+
+		vector<int> racing;
+
+		for (int i = 0; i < configurations.size(); ++i) {
+			if (!configurations[i].eliminated)
+				racing.push_back(i);
+		}
+
+		WorkStealingQueues scheduler(numberOfWorkers);
+		vector<double> scores(configurations.size(), 0.0);
+
+		for (int i = 0; i < racing.size(); ++i)
+			scheduler.push(i % numberOfWorkers, racing[i]);
+
+		vector<thread> workers;
+
+		for (int worker = 0; worker < numberOfWorkers; ++worker) {
+			workers.push_back(thread([&configurations, &scheduler, &scores, instance, upperBound, worker]() {
+				seedRandom(time(NULL) ^ ((unsigned long long)(worker + 1) << 32));
+
+				LNSWorkspace workspace;
+
+				// A configuration that fails scores nothing, so it's soon out of the race
+				for (int task = scheduler.next(worker); task != -1; task = scheduler.next(worker)) {
+					try {
+						LNSParameters taskParameters = configurations[task].parameters;
+						taskParameters.upperBound = upperBound;
+
+						int value = LNS::assignBacklogStories(LNS::run(instance, taskParameters, NULL, &workspace)).calculateValue();
+						scores[task] = upperBound > 0 ? (double)value / upperBound : 1.0;
+					}
+					catch (exception &) {
+						scores[task] = 0.0;
+					}
+				}
+			}));
+		}
+
+		for (thread &worker : workers)
+			worker.join();
+
+		int leader = racing[0];
+
+		for (int i : racing) {
+			configurations[i].scores.push_back(scores[i]);
+
+			if (configurations[i].meanScore() > configurations[leader].meanScore())
+				leader = i;
+		}
+
+		if (round + 1 >= firstTest) {
+			for (int i : racing) {
+				if (i != leader && significantlyWorse(configurations[i], configurations[leader]))
+					configurations[i].eliminated = true;
+			}
+		}
+
+		int left = count_if(configurations.begin(), configurations.end(), [](const TuningConfiguration &configuration) { return !configuration.eliminated; });
+
+		cout << "Instance " << round + 1 << " of " << order.size() << " (" << instanceNames[order[round]] << "): " << left << " configurations left, best mean score "
+			<< fixed << setprecision(4) << configurations[leader].meanScore() << endl;
+
+		if (left == 1)
+			break;
+	}
+
+	auto t_tuningEnd = chrono::high_resolution_clock::now();
+
+	// Summary table /////////////////////////////////////////////////////////
+	//////////////////////////////////////////////////////////////////////////
+
+	vector<int> survivors;
+
+	for (int i = 0; i < configurations.size(); ++i) {
+		if (!configurations[i].eliminated)
+			survivors.push_back(i);
+	}
+
+	sort(survivors.begin(), survivors.end(), [&configurations](int a, int b) { return configurations[a].meanScore() > configurations[b].meanScore(); });
+
+	cout << endl << left << setw(8) << "Config" << setw(44) << "Policies" << right
+		<< setw(12) << "Cooling" << setw(12) << "Destroy" << setw(12) << "Tenure" << setw(12) << "Restart" << setw(10) << "Budget"
+		<< setw(12) << "Mean %" << setw(11) << "Instances" << endl;
+
+	for (int i : survivors) {
+		const LNSParameters &survivor = configurations[i].parameters;
+
+		cout << left << setw(8) << (i == 0 ? string("given") : to_string(i)) << setw(44) << survivor.engineName() << right
+			<< setprecision(6) << setw(12) << survivor.coolingRate << setprecision(3) << setw(12) << survivor.degreeOfDestruction
+			<< setprecision(4) << setw(12) << survivor.tabuTenureFraction << setprecision(3) << setw(12) << survivor.maxNonImprovingFraction
+			<< setw(10) << survivor.iterationBudget << setprecision(2) << setw(12) << 100.0 * configurations[i].meanScore()
+			<< setw(11) << configurations[i].scores.size() << endl;
+	}
+
+	ofstream configFile(configFileName);
+
+	if (!configFile.is_open()) {
+		cout << "Cannot open config file" << endl;
+		exit(0);
+	}
+
+	configFile << configurations[survivors[0]].parameters.toConfig();
+
+	cout << endl << "Raced " << configurations.size() << " configurations with " << numberOfWorkers << " workers in "
+		<< chrono::duration<double, std::milli>(t_tuningEnd - t_tuningStart).count() << " ms, the best is saved in " << configFileName << endl;
+
+	if (statsEnabled)
+		printStats();
+}
+
+// Differential fuzz testing ///////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+
+// Story and sprint data files of a random problem: up to 300 stories (more than one chunk of an AssignmentArray), listed in a random order,
+// with sparse IDs half the time and dependencies only on stories earlier in a hidden ordering so they never form a cycle
+pair<string, string> randomProblemData() {
+	int numberOfStories = randomInt(1, 300);
+	int numberOfSprints = randomInt(1, 12);
+	int dependencyChance = randomInt(0, 30);
+
+	vector<int> storyIds(numberOfStories);
+
+	for (int i = 0; i < numberOfStories; ++i)
+		storyIds[i] = randomInt(0, 1) == 0 ? i + 1 : i * randomInt(2, 50) + randomInt(0, 1);
+
+	// Keeps the sparse IDs unique
+	sort(storyIds.begin(), storyIds.end());
+	storyIds.erase(unique(storyIds.begin(), storyIds.end()), storyIds.end());
+	numberOfStories = storyIds.size();
+	randomShuffle(storyIds);
 
-		for (int i = 0; i < roadmap.stories.size(); ++i) {
-			visited[i] = false;
+	vector<string> storyRows;
+
+	for (int i = 0; i < numberOfStories; ++i) {
+		string row = to_string(storyIds[i]) + "," + to_string(randomInt(1, 20)) + "," + to_string(randomInt(1, 13));
+		string dependencies;
+
+		for (int j = 0; j < i; ++j) {
+			if (randomInt(1, 1000) <= dependencyChance)
+				dependencies += (dependencies.empty() ? "" : ";") + to_string(storyIds[j]);
 		}
 
-		queue<Story> queue;
+		if (!dependencies.empty())
+			row += "," + dependencies;
 
-		visited[story.storyNumber] = true;
-		queue.push(story);
+		storyRows.push_back(row);
+	}
 
-		while (!queue.empty() && removedStories.size() < numberOfStoriesToRemove) {
-			story = queue.front();
-			queue.pop();
+	randomShuffle(storyRows);
 
-			// Only add the story if it's not already in the list of removed stories
-			if (find(removedStories.begin(), removedStories.end(), story) == removedStories.end())
-				removedStories.push_back(story);
+	string storyData = "story_id,business_value,story_points,dependencies\n";
 
-			for (int dependeeNumber : story.dependencies) {
-				Story dependee = roadmap.stories[dependeeNumber];
+	for (string &row : storyRows)
+		storyData += row + "\n";
 
-				if (!visited[dependee.storyNumber]) {
-					visited[dependee.storyNumber] = true;
-					queue.push(dependee);
-				}
-			}
-		}
+	string sprintData = "sprint_number,sprint_capacity,sprint_bonus\n";
+
+	for (int sprint = 1; sprint <= numberOfSprints; ++sprint)
+		sprintData += to_string(sprint) + "," + to_string(randomInt(5, 40)) + "," + to_string(randomInt(1, 10)) + "\n";
+
+	return make_pair(storyData, sprintData);
+}
 
-		return removedStories;
+// Description of the first thing the roadmap and the reference disagree on, or empty if they agree on everything
+string compareWithReference(Roadmap &roadmap, const ReferenceRoadmap &reference) {
+	for (int storyNumber = 0; storyNumber < roadmap.numberOfStories(); ++storyNumber) {
+		if (roadmap.assignedSprints[storyNumber] != reference.assignedSprints[storyNumber])
+			return "reference disagrees on assignment of story " + to_string(storyNumber);
 	}
 
-	// Removes the given number of stories and its dependencies
-	static DestroyedRoadmap radialRuin(Roadmap completeSolution, int numberOfStoriesToRemove) {
-		// The list of the stories removed from the solution
-		vector<Story> removedStories;
-		vector<Move> moves;
+	if (roadmap.sprintLoads != reference.sprintLoads())
+		return "reference disagrees on sprint loads";
 
-		// Used to randomly select stories without replacement
-		vector<Story> stories = completeSolution.stories;
+	if (roadmap.overloadedSprints != reference.overloadedSprints())
+		return "reference disagrees on count of overloaded sprints";
 
-		while (removedStories.size() < numberOfStoriesToRemove) {
-			Story randomStory = stories[randomInt(0, stories.size() - 1)];
+	if (roadmap.precedenceViolations != reference.precedenceViolations())
+		return "reference disagrees on count of precedence violations";
 
-			// Add the story's dependencies to the list
-			removedStories = traverseDependenciesBF(randomStory, completeSolution, removedStories, numberOfStoriesToRemove);
+	if (roadmap.calculateValue() != reference.calculateValue())
+		return "reference disagrees on value";
 
-			for (Story removedStory : removedStories) {
-				// Remove the stories from their sprints
-				Sprint removedStorySprint = completeSolution.storyToSprint[removedStory];
-				completeSolution.removeStoryFromSprint(removedStory, removedStorySprint);
+	if (roadmap.isFeasible() != reference.isFeasible() || roadmap.verifyFeasibility() != reference.isFeasible())
+		return "reference disagrees on feasibility";
 
-				// Remove the story from the list on unremoved stories
-				stories.erase(remove(stories.begin(), stories.end(), removedStory), stories.end());
+	return "";
+}
 
-				// Add to the list of moves (which will be checked against the tabu list later)
-				moves.push_back(Move(removedStory, removedStorySprint));
-			}
-		}
+// Moves a random story to a random sprint (or out of the roadmap) in both, checking they agree on whether the move is a valid insert.
+// Invalid moves are made some of the time too, so the counts of violations get exercised
+string randomMove(Roadmap &roadmap, ReferenceRoadmap &reference) {
+	int storyNumber = randomInt(0, roadmap.numberOfStories() - 1);
 
-		return DestroyedRoadmap(completeSolution, removedStories, moves);
+	if (roadmap.isAssigned(storyNumber) && randomInt(0, 2) == 0) {
+		roadmap.removeStoryFromSprint(storyNumber);
+		reference.assign(storyNumber, -1);
+		return "";
 	}
 
-	// Randomly selects stories to remove
-	static DestroyedRoadmap randomRuin(Roadmap completeSolution, int numberOfStoriesToRemove) {
-		// The list of the stories removed from the solution
-		vector<Story> removedStories;
-		vector<Move> moves;
+	int sprint = randomInt(0, roadmap.numberOfSprints() - 1);
 
-		// Used to randomly select stories without replacement
-		vector<Story> stories = completeSolution.stories;
+	if (roadmap.isAssigned(storyNumber)) {
+		roadmap.removeStoryFromSprint(storyNumber);
+		reference.assign(storyNumber, -1);
+	}
 
-		while (removedStories.size() < numberOfStoriesToRemove) {
-			Story randomStory = stories[randomInt(0, stories.size() - 1)];
-			Sprint randomStorySprint = completeSolution.storyToSprint[randomStory];
+	bool valid = roadmap.validInsert(storyNumber, sprint);
 
-			removedStories.push_back(randomStory);
-			completeSolution.removeStoryFromSprint(randomStory, randomStorySprint);
+	if (valid != reference.validInsert(storyNumber, sprint))
+		return "reference disagrees on validInsert of story " + to_string(storyNumber) + " into sprint " + to_string(sprint);
 
-			// Remove the story from the list on unremoved stories
-			stories.erase(remove(stories.begin(), stories.end(), randomStory), stories.end());
+	if (valid || randomInt(0, 3) == 0) {
+		roadmap.addStoryToSprint(storyNumber, sprint);
+		reference.assign(storyNumber, sprint);
+	}
 
-			// Add to the list of moves (which will be checked against the tabu list later)
-			moves.push_back(Move(randomStory, randomStorySprint));
-		}
+	return "";
+}
 
-		return DestroyedRoadmap(completeSolution, removedStories, moves);
-	}
+// Runs random moves and short searches on random problems, checking Roadmap against ReferenceRoadmap after every step.
+// Each problem has a seed of its own, printed if anything disagrees so the problem can be looked at again. Returns the exit code
+int runFuzz(int numberOfProblems, unsigned long long seed) {
+	auto t_fuzzStart = chrono::high_resolution_clock::now();
+	long long moves = 0;
 
-	// Adds the list of stories to the earliest sprint where they will fit & have their dependencies fulfilled
-	static RepairedRoadmap greedyInsertStories(vector<Story> storiesToInsert, Roadmap roadmap) {
-		// The list of moves that repaired the destroyed solution
-		vector<Move> moves;
+	for (int problem = 0; problem < numberOfProblems; ++problem) {
+		unsigned long long problemSeed = seed + problem;
+		seedRandom(problemSeed);
 
-		while (storiesToInsert.size() > 0) {
-			Story story = storiesToInsert[0];
+		pair<string, string> data = randomProblemData();
+		istringstream storyRows(data.first), sprintRows(data.second);
+		shared_ptr<const ProblemInstance> instance = make_shared<ProblemInstance>(loadStories(storyRows), loadSprints(sprintRows));
 
-			// Greedily re-insert the story into a sprint
-			for (Sprint sprint : roadmap.sprints) {
-				if (sprint.sprintNumber == -1 || roadmap.validInsert(story, sprint)) {
-					roadmap.addStoryToSprint(story, sprint);
-					storiesToInsert.erase(remove(storiesToInsert.begin(), storiesToInsert.end(), story), storiesToInsert.end());
+		string mismatch;
+		Roadmap roadmap(instance);
+		ReferenceRoadmap reference(instance);
+		int numberOfMoves = randomInt(1, 4 * instance->numberOfStories);
 
-					// Add to the list of moves (which will be checked against the tabu list later)
-					moves.push_back(Move(story, sprint));
+		for (int move = 0; move < numberOfMoves && mismatch.empty(); ++move) {
+			mismatch = randomMove(roadmap, reference);
 
-					// Break out of traversing the sprints and move to the next story
-					break;
+			if (mismatch.empty())
+				mismatch = compareWithReference(roadmap, reference);
+
+			// Copies share chunks until one of them changes, so moves on a copy mustn't show through in the original
+			if (mismatch.empty() && move == numberOfMoves / 2) {
+				Roadmap copy = roadmap;
+				ReferenceRoadmap copyReference = reference;
+
+				for (int copyMove = 0; copyMove < 20 && mismatch.empty(); ++copyMove) {
+					mismatch = randomMove(copy, copyReference);
+
+					if (mismatch.empty())
+						mismatch = compareWithReference(copy, copyReference);
 				}
+
+				if (mismatch.empty() && !compareWithReference(roadmap, reference).empty())
+					mismatch = "original changed by moves on its copy";
 			}
+
+			++moves;
 		}
 
-		return RepairedRoadmap(roadmap, moves);
-	}
+		// A short search from scratch has to come back with a roadmap the reference agrees is feasible and worth what the search says
+		if (mismatch.empty()) {
+			LNSParameters parameters;
+			parameters.maxIterations = 50;
+			parameters.useLocalSearch = randomInt(0, 1) == 0;
 
-	// Repair a partly destroyed solution to a complete solution
-	static RepairedRoadmap repair(DestroyedRoadmap destroyedSolution) {
-		sort(destroyedSolution.removedStories.begin(), destroyedSolution.removedStories.end(), StoryGreedySorting());
-		return greedyInsertStories(destroyedSolution.removedStories, destroyedSolution.roadmap);
-	}
+			Roadmap solution = LNS::assignBacklogStories(LNS::run(instance, parameters));
+			ReferenceRoadmap solutionReference(instance);
 
-	// Returns whether the temporary solution should become the new current solution
-	static bool accept(RepairedRoadmap repairedSolution, int repairedSolutionValue, int currentSolutionValue, double temperature, int currentIteration, TabuList *tabuList) {
-		double delta = repairedSolutionValue - currentSolutionValue;
+			for (int storyNumber = 0; storyNumber < solution.numberOfStories(); ++storyNumber)
+				solutionReference.assign(storyNumber, solution.assignedSprints[storyNumber]);
 
-		// Always accept an improving solution (part of the simulated annealing acceptance and tabu aspiration criteria)
-		if (delta > 0)
-			return true;
+			mismatch = compareWithReference(solution, solutionReference);
 
-		// Check if any of the moves made during the repair are tabu
-		for (Move move : repairedSolution.moves) {
-			// Don't accept the repaired solution if one of the moves is tabu
-			if (tabuList->isTabu(move, currentIteration))
-				return false;
+			if (mismatch.empty() && !solutionReference.isFeasible())
+				mismatch = "search returned an infeasible roadmap";
 		}
 
-		// Accept non-improving moves with probability related to the annealing temperature
-		if (exp(delta / temperature) > randomDouble(0, 1))
-			return true;
+		if (!mismatch.empty()) {
+			cout << "Problem " << problem << " (seed " << problemSeed << ", " << instance->numberOfStories << " stories, "
+				<< instance->numberOfSprints() - 1 << " sprints): " << mismatch << endl;
+			return 1;
+		}
+	}
 
-		// Didn't meet any of the expected criteria above, just reject the new solution
-		return false;
+	auto t_fuzzEnd = chrono::high_resolution_clock::now();
+
+	cout << "Fuzzed " << numberOfProblems << " problems (seeds " << seed << " to " << seed + numberOfProblems - 1 << ") with " << moves << " moves in "
+		<< chrono::duration<double, std::milli>(t_fuzzEnd - t_fuzzStart).count() << " ms, no disagreements with the reference" << endl;
+
+	return 0;
+}
+
+#ifndef _WIN32
+// Reads from a socket as an input stream, so that requests over a socket are parsed the same way as from stdin
+class SocketStreamBuffer : public streambuf {
+public:
+	int socket;
+	char buffer[4096];
+
+	SocketStreamBuffer(int socket) {
+		this->socket = socket;
+		setg(buffer, buffer, buffer);
 	}
 
-	static Roadmap randomRoadmap(vector<Story> storyData, vector<Sprint> sprintData) {
-		vector<Story> shuffledStories = storyData;
-		random_shuffle(shuffledStories.begin(), shuffledStories.end());
-		RepairedRoadmap repairedRoadmap = LNS::greedyInsertStories(shuffledStories, Roadmap(storyData, sprintData));
-		return repairedRoadmap.roadmap;
+protected:
+	int underflow() {
+		ssize_t bytesRead = recv(socket, buffer, sizeof(buffer), 0);
+
+		if (bytesRead <= 0)
+			return traits_type::eof();
+
+		setg(buffer, buffer, buffer + bytesRead);
+		return traits_type::to_int_type(buffer[0]);
 	}
+};
 
-	static int maxDifference(vector<int> integers) {
-		int minElement = integers[0];
-		int maxElement = integers[1];
+// A client connected to the service's socket, closed once the client has hung up and every response has been sent
+class SocketConnection {
+public:
+	int socket;
+	mutex sendMutex;
 
-		// The maximum difference is the difference between the smallest and largest elements.
-		// So find the min and max integers in the list
-		for (int element : integers) {
-			if (element < minElement)
-				minElement = element;
-			else if (element > maxElement)
-				maxElement = element;
-		}
+	SocketConnection(int socket) {
+		this->socket = socket;
+	}
 
-		return maxElement - minElement;
+	~SocketConnection() {
+		close(socket);
 	}
 
-	static double calculateInitialTemperature(vector<Story> storyData, vector<Sprint> sprintData) {
-		int trials = storyData.size() * sprintData.size();
+	void send(string message) {
+		lock_guard<mutex> lock(sendMutex);
 
-		vector<int> randomSolutionValues;
+		for (size_t sent = 0; sent < message.size();) {
+			ssize_t bytesSent = ::send(socket, message.data() + sent, message.size() - sent, MSG_NOSIGNAL);
 
-		for (int i = 0; i < trials; ++i) {
-			randomSolutionValues.push_back(randomRoadmap(storyData, sprintData).calculateValue());
+			// The client has gone away, there's nobody to send the rest to
+			if (bytesSent <= 0)
+				return;
+
+			sent += bytesSent;
 		}
+	}
+};
 
-		return maxDifference(randomSolutionValues);
+// Accepts clients on a Unix domain socket forever, serving each one's requests on its own thread
+void serveSocket(string socketPath, SolverService &service) {
+	signal(SIGPIPE, SIG_IGN);
+
+	int listeningSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+	unlink(socketPath.c_str());
+
+	if (listeningSocket < 0 || ::bind(listeningSocket, (sockaddr *)&address, sizeof(address)) < 0 || listen(listeningSocket, 64) < 0) {
+		cout << "Cannot listen on socket " << socketPath << endl;
+		exit(0);
 	}
 
-	static Roadmap run(vector<Story> storyData, vector<Sprint> sprintData) {
-		// TODO
-		// - Dynamically set the number of elements to destroy and the Tabu tenure
-		//		- if the previous n iterations didn't improve, increase by 1
-		//		- cap the maximum
+	while (true) {
+		int clientSocket = accept(listeningSocket, NULL, NULL);
 
-		int problemSize = storyData.size() * sprintData.size();
+		if (clientSocket < 0)
+			continue;
 
-		// Tabu parameters ///////////////////////////////////////////////////////
-		//////////////////////////////////////////////////////////////////////////
+		shared_ptr<SocketConnection> connection = make_shared<SocketConnection>(clientSocket);
 
-		int tabuTenure = problemSize * 0.1;
-		TabuList tabuList(tabuTenure);
+		thread([connection, &service]() {
+			SocketStreamBuffer streamBuffer(connection->socket);
+			istream input(&streamBuffer);
 
-		// Simulated annealing parameters ////////////////////////////////////////
-		//////////////////////////////////////////////////////////////////////////
+			serveRequests(input, service, [connection](string message) { connection->send(message); });
+		}).detach();
+	}
+}
+#endif
 
-		double startTemperature = calculateInitialTemperature(storyData, sprintData);
-		double temperature = startTemperature;
-		double coolingRate = 0.9;
+int main(int argc, char* argv[]) {
+	// Seed the random number generator
+	seedRandom(time(NULL));
 
-		//////////////////////////////////////////////////////////////////////////
-		//////////////////////////////////////////////////////////////////////////
+	vector<Story> storyData;
+	string storyDataFileName;
 
-		Roadmap currentSolution = randomRoadmap(storyData, sprintData);
-		Roadmap bestSolution = currentSolution;
+	// Holds the data about each sprint
+	vector<Sprint> sprintData;
+	string sprintDataFileName;
 
-		// Storing the values saves recomputing the same thing at every iteration when comparing with new solutions
-		int currentSolutionValue = currentSolution.calculateValue();
-		int bestSolutionValue = currentSolutionValue;
+	LNSParameters parameters;
+	bool iterationBudgetSet = false;
 
-		int ruinMode = 0; // 0 = radial, 1 = random
-		double degreeOfDestruction = 0.15;
-		int numberOfStoriesToRemove = max(1.0, round(degreeOfDestruction * currentSolution.stories.size()));
+	// Assignments of a previous run to re-plan from, and where to save the new assignments
+	string previousAssignmentsFileName;
+	string outputAssignmentsFileName;
 
-		int maxIterations = 2 * problemSize;
-		int nonImprovingIterations = 0;
-		int maxNonImprovingIterations = maxIterations / 10.0; // maximum of 10 random restarts
+	// Print only the stories that moved from the previous assignments, rather than the whole roadmap
+	bool diffOutput = false;
 
-		for (int currentIteration = 0; currentIteration < maxIterations; ++currentIteration) {
-			//cout << currentSolutionValue << "," << bestSolutionValue << endl;
+	// Service mode reads requests from stdin or a Unix domain socket rather than solving a single pair of files
+	bool serveStdin = false;
+	string batchManifestFileName;
+	string socketPath;
+	int numberOfWorkers = max(1u, thread::hardware_concurrency());
 
-			if (nonImprovingIterations > maxNonImprovingIterations) {
-				nonImprovingIterations = 0;
-				temperature = startTemperature; // temperature gets reset when a random restart occurs
+	// Very large problems are solved through a hierarchy of coarser problems of at most this many stories at the top
+	bool multilevel = false;
+	int coarseSize = 1000;
 
-				currentSolution = randomRoadmap(storyData, sprintData);
-				currentSolutionValue = currentSolution.calculateValue();
-			}
+	// What-if variants of the problem to solve alongside it
+	string scenariosFileName;
 
-			DestroyedRoadmap destroyedSolution;
+	// Parallel tempering runs a replica of the search per worker at a ladder of temperatures, exchanging them every so many iterations
+	bool tempering = false;
+	int exchangeInterval = 100;
 
-			if (ruinMode == 0) {
-				destroyedSolution = radialRuin(currentSolution, numberOfStoriesToRemove);
-			}
-			else if (ruinMode == 1) {
-				destroyedSolution = randomRuin(currentSolution, numberOfStoriesToRemove);
-			}
+	// Directory of earlier solves to answer from or warm start from, and how big it can get in MB
+	string cacheDirectory;
+	long long cacheSize = 64;
 
-			ruinMode = (ruinMode + 1) % 2; // alternate to the other ruin mode
-			
-			RepairedRoadmap repairedSolution = repair(destroyedSolution);
-			int repairedSolutionValue = repairedSolution.roadmap.calculateValue();
+	// Tuning mode races random configurations of the search over the instances of a manifest and saves the best to a config file
+	string tuningManifestFileName;
+	int numberOfConfigurations = 40;
 
-			if (accept(repairedSolution, repairedSolutionValue, currentSolutionValue, temperature, currentIteration, &tabuList) && repairedSolution.roadmap.isFeasible()) {
-				currentSolution = repairedSolution.roadmap;
-				currentSolutionValue = repairedSolutionValue;
+	// Fuzz testing checks Roadmap against ReferenceRoadmap on this many random problems, from a given seed or a random one
+	int numberOfFuzzProblems = 0;
+	unsigned long long fuzzSeed = time(NULL);
 
-				// Update the tabu list:
-				// - moves made in the destroyed solution represent moving story A out of sprint B
-				// - adding move 'story A -> sprint B' prevents undoing the move
-				for (Move move : destroyedSolution.moves)
-					tabuList.add(move, currentIteration);
+	// Options can appear anywhere, everything else is a data file name
+	vector<string> fileNames;
 
-				if (currentSolutionValue > bestSolutionValue && currentSolution.isFeasible()) {
-					bestSolution = currentSolution;
-					bestSolutionValue = currentSolutionValue;
+	for (int i = 1; i < argc; ++i) {
+		string argument = argv[i];
 
-					nonImprovingIterations = 0;
-				}
-				else {
-					++nonImprovingIterations;
-				}
-			}
-			else {
-				++nonImprovingIterations;
+		if (argument == "--gap" && i + 1 < argc)
+			parameters.optimalityGap = stod(argv[++i]);
+		else if (argument == "--budget" && i + 1 < argc) {
+			parameters.iterationBudget = stod(argv[++i]);
+			iterationBudgetSet = true;
+		}
+		else if (argument == "--previous" && i + 1 < argc)
+			previousAssignmentsFileName = argv[++i];
+		else if (argument == "--output" && i + 1 < argc)
+			outputAssignmentsFileName = argv[++i];
+		else if (argument == "--diff")
+			diffOutput = true;
+		else if (argument == "--batch" && i + 1 < argc)
+			batchManifestFileName = argv[++i];
+		else if (argument == "--serve")
+			serveStdin = true;
+		else if (argument == "--socket" && i + 1 < argc)
+			socketPath = argv[++i];
+		else if (argument == "--workers" && i + 1 < argc)
+			numberOfWorkers = max(1, stoi(argv[++i]));
+		else if (argument == "--compact")
+			parameters.compactMode = true;
+		else if (argument == "--candidates" && i + 1 < argc)
+			parameters.candidatesPerIteration = max(1, stoi(argv[++i]));
+		else if (argument == "--no-local-search")
+			parameters.useLocalSearch = false;
+		else if (argument == "--checkpoint" && i + 1 < argc)
+			parameters.checkpointFileName = argv[++i];
+		else if (argument == "--checkpoint-interval" && i + 1 < argc)
+			parameters.checkpointInterval = stod(argv[++i]);
+		else if (argument == "--resume")
+			parameters.resume = true;
+		else if (argument == "--scenarios" && i + 1 < argc)
+			scenariosFileName = argv[++i];
+		else if (argument == "--multilevel")
+			multilevel = true;
+		else if (argument == "--coarse-size" && i + 1 < argc)
+			coarseSize = max(1, stoi(argv[++i]));
+		else if (argument == "--stats" || argument == "--stats-json" || argument == "--perf") {
+#ifndef LNS_DISABLE_STATS
+			statsEnabled = true;
+
+			if (argument == "--stats-json")
+				statsAsJson = true;
+
+			if (argument == "--perf") {
+				// Hardware counters come on top of the usual statistics, and the solve goes ahead without them if they can't be opened
+				if (threadPerfCounters().available())
+					perfEnabled = true;
+				else
+					cout << "Hardware counters unavailable (" << threadPerfCounters().error << "), reporting times only" << endl;
 			}
-
-			temperature *= coolingRate;
+#else
+			cout << "Statistics aren't available, this build has them disabled (LNS_DISABLE_STATS)" << endl;
+#endif
+		}
+		else if (argument == "--ruin" && i + 1 < argc)
+			parameters.ruinPolicy = argv[++i];
+		else if (argument == "--repair" && i + 1 < argc)
+			parameters.repairPolicy = argv[++i];
+		else if (argument == "--accept" && i + 1 < argc)
+			parameters.acceptancePolicy = argv[++i];
+		else if (argument == "--cooling" && i + 1 < argc)
+			parameters.coolingPolicy = argv[++i];
+		else if (argument == "--cooling-rate" && i + 1 < argc)
+			parameters.coolingRate = stod(argv[++i]);
+		else if (argument == "--destruction" && i + 1 < argc)
+			parameters.degreeOfDestruction = stod(argv[++i]);
+		else if (argument == "--tabu-tenure" && i + 1 < argc)
+			parameters.tabuTenureFraction = stod(argv[++i]);
+		else if (argument == "--non-improving" && i + 1 < argc)
+			parameters.maxNonImprovingFraction = stod(argv[++i]);
+		else if (argument == "--elite-pool" && i + 1 < argc)
+			parameters.elitePoolSize = max(0, stoi(argv[++i]));
+		else if (argument == "--time-limit" && i + 1 < argc)
+			parameters.timeLimit = stod(argv[++i]);
+		else if (argument == "--config" && i + 1 < argc) {
+			// Options after the config file override it
+			loadConfig(argv[++i], parameters);
+			iterationBudgetSet = true;
 		}
+		else if (argument == "--tempering")
+			tempering = true;
+		else if (argument == "--exchange-interval" && i + 1 < argc)
+			exchangeInterval = max(1, stoi(argv[++i]));
+		else if (argument == "--cache" && i + 1 < argc)
+			cacheDirectory = argv[++i];
+		else if (argument == "--cache-size" && i + 1 < argc)
+			cacheSize = max(1LL, stoll(argv[++i]));
+		else if (argument == "--tune" && i + 1 < argc)
+			tuningManifestFileName = argv[++i];
+		else if (argument == "--configurations" && i + 1 < argc)
+			numberOfConfigurations = max(1, stoi(argv[++i]));
+		else if (argument == "--fuzz" && i + 1 < argc)
+			numberOfFuzzProblems = max(1, stoi(argv[++i]));
+		else if (argument == "--fuzz-seed" && i + 1 < argc)
+			fuzzSeed = stoull(argv[++i]);
+		else if (argument == "--verify-interval" && i + 1 < argc) {
+#ifdef LNS_VERIFY
+			verifyInterval = max(1LL, stoll(argv[++i]));
+#else
+			++i;
+			cout << "Verification isn't available, this build doesn't have it (LNS_VERIFY)" << endl;
+#endif
+		}
+		else
+			fileNames.push_back(argument);
+	}
 
-		return bestSolution;
+	try {
+		parameters.validate();
+	}
+	catch (exception &e) {
+		cout << "Invalid search settings: " << e.what() << endl;
+		exit(0);
 	}
-};
 
-vector<string> splitString(const string& s, char delimiter) {
-	vector<string> tokens;
-	string token;
-	istringstream tokenStream(s);
+	if (!lnsEngines().count(parameters.engineName())) {
+		cout << "Unknown search configuration: " << parameters.engineName() << " (expected --ruin alternating|radial|random, --repair knapsack|greedy, "
+			<< "--accept annealing|improving, --cooling geometric|linear)" << endl;
+		exit(0);
+	}
 
-	while (getline(tokenStream, token, delimiter)) {
-		tokens.push_back(token);
+	// A checkpoint file holds the state of one search, so it can't be shared by the many solves of batch and service mode
+	if (!parameters.checkpointFileName.empty() && (!batchManifestFileName.empty() || serveStdin || !socketPath.empty())) {
+		cout << "Checkpoints are only supported when solving a single instance" << endl;
+		exit(0);
 	}
 
-	return tokens;
-}
+	// Each level of a multilevel solve is a search of its own, so there's no single search to checkpoint or warm start
+	if (multilevel && (!batchManifestFileName.empty() || serveStdin || !socketPath.empty() || !parameters.checkpointFileName.empty() || !previousAssignmentsFileName.empty())) {
+		cout << "Multilevel solving is only supported when solving a single instance from scratch, without checkpoints" << endl;
+		exit(0);
+	}
 
-int main(int argc, char* argv[]) {
-	// Seed the random number generator
-	srand(time(NULL));
+	// Scenarios are each warm-started from the base solution, which is always solved from scratch
+	if (!scenariosFileName.empty() && (!batchManifestFileName.empty() || serveStdin || !socketPath.empty() || !parameters.checkpointFileName.empty() || !previousAssignmentsFileName.empty() || multilevel)) {
+		cout << "Scenarios are only supported when solving a single instance from scratch, without checkpoints" << endl;
+		exit(0);
+	}
 
-	vector<Story> storyData;
-	string storyDataFileName;
+	// The replicas are searches of their own from random roadmaps, so there's no single search to checkpoint or warm start
+	if (tempering && (!batchManifestFileName.empty() || serveStdin || !socketPath.empty() || !parameters.checkpointFileName.empty()
+		|| !previousAssignmentsFileName.empty() || multilevel || !scenariosFileName.empty())) {
+		cout << "Parallel tempering is only supported when solving a single instance from scratch, without checkpoints" << endl;
+		exit(0);
+	}
 
-	// Holds the data about each sprint
-	vector<Sprint> sprintData;
-	string sprintDataFileName;
+	// The cache warm starts plain searches itself, from scratch otherwise
+	if (!cacheDirectory.empty() && (!batchManifestFileName.empty() || serveStdin || !socketPath.empty() || !parameters.checkpointFileName.empty()
+		|| !previousAssignmentsFileName.empty() || multilevel || tempering || !scenariosFileName.empty() || !tuningManifestFileName.empty())) {
+		cout << "The solution cache is only supported when solving a single instance with the plain search, without checkpoints or warm starts" << endl;
+		exit(0);
+	}
 
-	switch (argc) {
-	case 3:
-		storyDataFileName = argv[1];
-		sprintDataFileName = argv[2];
-		break;
-	default:
+	// Tuning runs many searches of its own on the manifest's instances
+	if (!tuningManifestFileName.empty() && (!batchManifestFileName.empty() || serveStdin || !socketPath.empty() || !parameters.checkpointFileName.empty()
+		|| !previousAssignmentsFileName.empty() || multilevel || !scenariosFileName.empty() || tempering)) {
+		cout << "Tuning can't be combined with other modes, checkpoints or warm starts" << endl;
 		exit(0);
 	}
 
-	// Load story data into objects //////////////////////////////////////////
-	//////////////////////////////////////////////////////////////////////////
+	if (!tuningManifestFileName.empty() && parameters.timeLimit <= 0) {
+		cout << "Tuning needs the time each search gets, to tune for (--time-limit)" << endl;
+		exit(0);
+	}
 
-	string line;
-	ifstream storiesFile(storyDataFileName);
+	if (diffOutput && previousAssignmentsFileName.empty()) {
+		cout << "--diff needs the previous assignments to compare with (--previous)" << endl;
+		exit(0);
+	}
 
-	getline(storiesFile, line); // Skip column headers
+	// Fuzz testing mode ///////////////////////////////////////////////////////
+	//////////////////////////////////////////////////////////////////////////
 
-	vector<pair<int, string>> dependenciesStrings;
+	if (numberOfFuzzProblems > 0)
+		return runFuzz(numberOfFuzzProblems, fuzzSeed);
 
-	if (storiesFile.is_open()) {
-		while (getline(storiesFile, line)) {
-			vector<string> splitLine = splitString(line, ',');
+	// Tuning mode /////////////////////////////////////////////////////////////
+	//////////////////////////////////////////////////////////////////////////
 
-			int storyNumber = stoi(splitLine[0]);
-			int businessValue = stoi(splitLine[1]);
-			int storyPoints = stoi(splitLine[2]);
+	if (!tuningManifestFileName.empty()) {
+		runTuning(tuningManifestFileName, parameters, numberOfConfigurations, outputAssignmentsFileName.empty() ? "tuned_config.csv" : outputAssignmentsFileName, numberOfWorkers);
+		return 0;
+	}
 
-			storyData.push_back(Story(storyNumber, businessValue, storyPoints));
+	// Batch mode //////////////////////////////////////////////////////////////
+	//////////////////////////////////////////////////////////////////////////
 
-			if (splitLine.size() == 4) {
-				string dependencyString = splitLine[3];
+	if (!batchManifestFileName.empty()) {
+		runBatch(batchManifestFileName, parameters, numberOfWorkers);
+		return 0;
+	}
 
-				vector<string> splitDependencies = splitString(dependencyString, ';');
+	// Service mode ////////////////////////////////////////////////////////////
+	//////////////////////////////////////////////////////////////////////////
 
-				for (string dependeeString : splitDependencies) {
-					storyData[storyNumber].dependencies.push_back(stoi(dependeeString));
-				}
-			}
-		}
+	if (serveStdin || !socketPath.empty()) {
+		SolverService service(numberOfWorkers);
 
-		for (Story story : storyData) {
-			for (int dependency : story.dependencies) {
-				storyData[dependency].dependees.push_back(story.storyNumber);
-			}
+		if (!socketPath.empty()) {
+#ifndef _WIN32
+			serveSocket(socketPath, service);
+#else
+			cout << "Unix domain sockets aren't supported on this platform, use --serve instead" << endl;
+			exit(0);
+#endif
 		}
-	} else {
+
+		mutex outputMutex;
+
+		serveRequests(cin, service, [&outputMutex](string message) {
+			lock_guard<mutex> lock(outputMutex);
+			cout << message << flush;
+		});
+
+		service.shutdown();
+		return 0;
+	}
+
+	switch (fileNames.size()) {
+	case 2:
+		storyDataFileName = fileNames[0];
+		sprintDataFileName = fileNames[1];
+		break;
+	default:
+		cout << "Usage: AgileLocalSearch <story data file> <sprint data file> [--gap <fraction>] [--budget <fraction>] [--previous <assignments file> [--diff]] [--output <assignments file>] [--compact] [--candidates <number>] [--no-local-search]" << endl;
+		cout << "           [--ruin alternating|radial|random] [--repair knapsack|greedy] [--accept annealing|improving] [--cooling geometric|linear]" << endl;
+		cout << "           [--config <config file>] [--time-limit <seconds>] [--cooling-rate <fraction>] [--destruction <fraction>] [--tabu-tenure <fraction>] [--non-improving <fraction>]" << endl;
+		cout << "           [--elite-pool <size>] [--cache <directory> [--cache-size <MB>]]" << endl;
+		cout << "           [--tempering [--exchange-interval <iterations>] [--workers <number>]]" << endl;
+		cout << "           [--multilevel [--coarse-size <stories>]] [--scenarios <scenarios file> [--workers <number>]]" << endl;
+		cout << "           [--checkpoint <file> [--checkpoint-interval <seconds>] [--resume]] [--stats | --stats-json] [--perf]" << endl;
+		cout << "       AgileLocalSearch --batch <manifest file> [--workers <number>] [--compact] [--candidates <number>] [--stats | --stats-json] [--perf]" << endl;
+		cout << "       AgileLocalSearch --serve | --socket <path> [--workers <number>]" << endl;
+		cout << "       AgileLocalSearch --tune <manifest file> --time-limit <seconds> [--configurations <number>] [--output <config file>] [--workers <number>]" << endl;
+		cout << "       AgileLocalSearch --fuzz <problems> [--fuzz-seed <seed>]" << endl;
+		cout << "       (builds with LNS_VERIFY also take [--verify-interval <checks>] in any mode)" << endl;
+		exit(0);
+	}
+
+	// Load story data into objects //////////////////////////////////////////
+	//////////////////////////////////////////////////////////////////////////
+
+	ifstream storiesFile(storyDataFileName);
+
+	if (!storiesFile.is_open()) {
 		cout << "Cannot open story data file" << endl;
 		exit(0);
 	}
 
+	storyData = loadStories(storiesFile);
 	storiesFile.close();
 
 	// Load sprint data into objects /////////////////////////////////////////
@@ -860,61 +6007,155 @@ int main(int argc, char* argv[]) {
 
 	ifstream sprintsFile(sprintDataFileName);
 
-	getline(sprintsFile, line); // Skip column headers
-
-	if (sprintsFile.is_open()) {
-		while (getline(sprintsFile, line)) {
-			vector<string> splitLine = splitString(line, ',');
+	if (!sprintsFile.is_open()) {
+		cout << "Cannot open sprint data file" << endl;
+		exit(0);
+	}
 
-			int sprintNumber = stoi(splitLine[0]);
-			int sprintCapacity = stoi(splitLine[1]);
-			int sprintBonus = stoi(splitLine[2]);
+	sprintData = loadSprints(sprintsFile);
+	sprintsFile.close();
 
-			sprintData.push_back(Sprint(sprintNumber, sprintCapacity, sprintBonus));
-		}
+	// Every solution refers to this one copy of the data, so the story and sprint objects aren't needed any more
+	shared_ptr<const ProblemInstance> instance;
 
-		sprintData.push_back(Sprint(-1, 0, 0)); // A special sprint representing 'unassigned' (i.e. assigned to the product backlog)
-	} else {
-		cout << "Cannot open sprint data file" << endl;
+	try {
+		instance = make_shared<ProblemInstance>(storyData, sprintData);
+	}
+	catch (exception &e) {
+		cout << e.what() << endl;
 		exit(0);
 	}
 
-	sprintsFile.close();
+	vector<Story>().swap(storyData);
+	vector<Sprint>().swap(sprintData);
+
+	// Scenario mode ///////////////////////////////////////////////////////////
+	//////////////////////////////////////////////////////////////////////////
+
+	if (!scenariosFileName.empty()) {
+		// Like re-planning, each scenario only has to adapt the base roadmap to a few changes
+		runScenarios(instance, scenariosFileName, parameters, iterationBudgetSet ? parameters.iterationBudget : 0.25, numberOfWorkers);
+		return 0;
+	}
 
 	// Local search //////////////////////////////////////////////////////////
 	//////////////////////////////////////////////////////////////////////////
 
 	auto t_initialStart = chrono::high_resolution_clock::now();
 	
-	Roadmap bestSolution = LNS::run(storyData, sprintData);
+	Roadmap bestSolution;
+	map<int, int> previousAssignments;
+
+	// Keyed by the settings the search was asked for, before any are changed for a warm start
+	unique_ptr<SolutionCache> cache;
+	unsigned long long exactKey = 0, structureKey = 0;
+	map<int, int> cachedAssignments;
+	string cacheResult;
+
+	if (!cacheDirectory.empty()) {
+		cache.reset(new SolutionCache(cacheDirectory, cacheSize * 1024 * 1024));
+		exactKey = SolutionCache::exactKey(*instance, parameters);
+		structureKey = SolutionCache::structureKey(*instance);
+	}
 
-	// Greedily assign any unassigned stories, if possible
-	if (!bestSolution.sprintToStories.empty()) {
-		Sprint unassignedSprint = sprintData[sprintData.size() - 1];
-		vector<Story> unassignedStories = bestSolution.sprintToStories[unassignedSprint];
+	try {
+		if (cache && cache->lookupExact(exactKey, *instance, cachedAssignments)) {
+			// The same problem solved the same way, so the earlier roadmap is as good as a new solve
+			cacheResult = "exact hit";
+			bestSolution = LNS::warmStartRoadmap(instance, cachedAssignments);
+		}
+		else if (cache && cache->lookupStructure(structureKey, *instance, cachedAssignments)) {
+			// Like re-planning, only the few assignments the changes broke need repairing
+			cacheResult = "near hit, warm started";
 
-		// If there are stories assigned to the backlog, try to assign them greedily
-		if (!unassignedStories.empty()) {
-			// Remove the stories from the 'backlog' sprint
-			for (Story unassignedStory : unassignedStories) {
-				bestSolution.removeStoryFromSprint(unassignedStory, unassignedSprint);
-			}
+			if (!iterationBudgetSet)
+				parameters.iterationBudget = 0.25;
+
+			Roadmap warmStartSolution = LNS::warmStartRoadmap(instance, cachedAssignments);
+			bestSolution = LNS::run(instance, parameters, &warmStartSolution);
+		}
+		else if (!previousAssignmentsFileName.empty()) {
+			// Re-planning only has to repair a few assignments, so by default it gets a fraction of a cold solve's budget
+			if (!iterationBudgetSet)
+				parameters.iterationBudget = 0.25;
 
-			sort(unassignedStories.begin(), unassignedStories.end(), StoryGreedySorting());
-			bestSolution = LNS::greedyInsertStories(unassignedStories, bestSolution).roadmap;
+			previousAssignments = loadAssignments(previousAssignmentsFileName);
+
+			Roadmap warmStartSolution = LNS::warmStartRoadmap(instance, previousAssignments);
+			bestSolution = LNS::run(instance, parameters, &warmStartSolution);
+		}
+		else if (multilevel) {
+			bestSolution = LNS::runMultilevel(instance, parameters, coarseSize);
+		}
+		else if (tempering) {
+			bestSolution = LNS::runParallelTempering(instance, parameters, numberOfWorkers, exchangeInterval);
+		}
+		else {
+			cacheResult = "miss";
+			bestSolution = LNS::run(instance, parameters);
 		}
 	}
+	catch (exception &e) {
+		// Checkpoint files that can't be read or written
+		cout << e.what() << endl;
+		exit(0);
+	}
+
+	// Greedily assign any unassigned stories, if possible
+	bestSolution = LNS::assignBacklogStories(bestSolution);
 
 	auto t_solveEnd = chrono::high_resolution_clock::now();
+	int changedStories = 0;
 
-	// Pretty print solution /////////////////////////////////////////////////
-	//////////////////////////////////////////////////////////////////////////
+	if (cache && cacheResult != "exact hit")
+		cache->store(bestSolution, exactKey, structureKey);
+
+	{
+		STATS_TIMER(TIMER_OUTPUT);
+
+		if (!outputAssignmentsFileName.empty()) {
+			ofstream outputFile(outputAssignmentsFileName);
+			outputFile << bestSolution.printAssignments();
+		}
+
+		if (diffOutput) {
+			changedStories = bestSolution.writeChangedAssignments(cout, previousAssignments);
+		}
+		else {
+			// Pretty print solution /////////////////////////////////////////////////
+			//////////////////////////////////////////////////////////////////////////
 
-	//cout << endl << "Initial solution -----------------------------------------------" << endl << endl;
-	//cout << initialSolution.printSprintRoadmap();
+			//cout << endl << "Initial solution -----------------------------------------------" << endl << endl;
+			//cout << initialSolution.printSprintRoadmap();
 
-	//cout << endl << "Best solution --------------------------------------------------" << endl << endl;
-	cout << bestSolution.printSprintRoadmap();
+			//cout << endl << "Best solution --------------------------------------------------" << endl << endl;
+			cout << bestSolution.printSprintRoadmap();
+		}
+	}
+
+	// Consumers of the changes only need to know how much the re-plan gained on top of them
+	if (diffOutput) {
+		// What the previous assignments are worth with the current data (whether or not they're still feasible)
+		int previousValue = 0;
+
+		for (pair<const int, int> previousAssignment : previousAssignments) {
+			int storyNumber = instance->storyNumberOf(previousAssignment.first);
+			int sprint = instance->sprintPosition(previousAssignment.second);
+
+			if (storyNumber != -1 && sprint != -1)
+				previousValue += instance->storyValues[storyNumber] * instance->sprintBonus(sprint);
+		}
+
+		int value = bestSolution.calculateValue();
+
+		cout << endl << "Changed stories: " << changedStories << " of " << instance->numberOfStories << endl;
+		cout << "Total weighted business value: " << value << " (change: " << showpos << value - previousValue << noshowpos << ")" << endl;
+
+		if (statsEnabled)
+			printStats();
+
+		return 0;
+	}
 
 	//////////////////////////////////////////////////////////////////////////
 
@@ -925,11 +6166,25 @@ int main(int argc, char* argv[]) {
 	//cout << bestSolution.calculateValue() << "," << chrono::duration<double, std::milli>(t_solveEnd - t_initialStart).count() << endl;
 
 	cout << endl << "LNS" << endl;
-	cout << "Stories: " << storyData.size() << ", sprints: " << sprintData.size() - 1 << endl;
+	cout << "Stories: " << instance->numberOfStories << ", sprints: " << instance->numberOfSprints() - 1 << endl;
 	cout << "Solved in " << chrono::duration<double, std::milli>(t_solveEnd - t_initialStart).count() << " ms" << endl;
+
+	if (cache)
+		cout << "Cache: " << cacheResult << endl;
+
 	cout << "Total weighted business value: " << bestSolution.calculateValue() << endl;
+
+	int upperBound = LNS::calculateUpperBound(*instance);
+	double optimalityGap = upperBound > 0 ? 100.0 * (upperBound - bestSolution.calculateValue()) / upperBound : 0.0;
+
+	cout << "Upper bound: " << upperBound << " (optimality gap: " << optimalityGap << "%)" << endl;
+	cout << "Memory: " << instance->memoryUsage() / 1024 << " KB instance, " << bestSolution.memoryUsage() / 1024 << " KB per solution, "
+		<< peakMemoryUsage() / 1024 << " KB peak resident" << endl;
 	cout << "----------------------------------------" << endl;
 
+	if (statsEnabled)
+		printStats();
+
 	//cout << endl << storyData.size() << "," << sprintData.size() - 1 << "," << set << "," << repetition << "," << heuristic;
 	//cout << "," << bestSolution.calculateValue() << "," << chrono::duration<double, std::milli>(t_solveEnd - t_initialStart).count();
 